@@ -0,0 +1,406 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// Tested by search_test.cc, exhaustive_test.cc, tester.cc
+
+// Prog::SearchBitParallel is a bit-parallel simulation of the
+// position automaton (also known as the Glushkov automaton) for
+// small regular expressions.  Each ByteRange instruction in the
+// program is a "position" and gets one bit of a 64-bit word; the
+// remaining high bit records whether the program can match.
+// The set of threads waiting at the current position of the text
+// is therefore a single word, and advancing it over one byte is
+// a handful of table lookups, ANDs and ORs:
+//
+//   m = d & bytemask[c]                    (positions that accept c)
+//   d = follow[flags][m] | start[flags]    (where they can go next)
+//
+// follow[flags][m] is split into one table per 8-bit chunk of m,
+// so a program with up to 8 positions needs one lookup per byte,
+// with up to 16 positions needs two lookups and so on.
+//
+// Empty-width assertions are handled by computing the closures
+// for each combination of the kEmpty* flags that the program
+// actually uses.  The flags in effect at a position depend on the
+// bytes on either side of it, so the closure is taken only once the
+// next byte is known, just like the DFA does.
+//
+// Unlike the DFA, there is no state cache to build out, to lock or
+// to run out of, so throughput is the same in the worst case as in
+// the best.  Unlike the NFA, there is no per-thread bookkeeping.
+// The price is that thread priorities are lost: SearchBitParallel
+// can only say whether there is a match and, for anchored searches,
+// where the longest match ends.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "absl/base/call_once.h"
+#include "absl/log/absl_check.h"
+#include "absl/log/absl_log.h"
+#include "absl/strings/string_view.h"
+#include "re2/pod_array.h"
+#include "re2/prog.h"
+#include "re2/sparse_set.h"
+
+namespace re2 {
+
+// The bit in a state word that means "the program can match here".
+static const uint64_t kMatchBit = uint64_t{1} << 63;
+
+// Returns the set of positions (and possibly kMatchBit) reachable
+// from instruction list id0 without consuming a byte, given that
+// the kEmpty* flags in effect are flags.
+// pos maps instruction ids to positions.
+// visited and stk are preallocated scratch structures.
+static uint64_t Closure(Prog* prog, int id0, uint32_t flags, const int* pos,
+                        SparseSet* visited, std::vector<int>* stk) {
+  uint64_t mask = 0;
+  visited->clear();
+  stk->clear();
+  stk->push_back(id0);
+  while (!stk->empty()) {
+    int id = stk->back();
+    stk->pop_back();
+    if (id == 0 || visited->contains(id))
+      continue;
+    visited->insert_new(id);
+
+    // Walk the instruction list.
+    for (;; id++) {
+      Prog::Inst* ip = prog->inst(id);
+      switch (ip->opcode()) {
+        default:
+          ABSL_LOG(DFATAL) << "unhandled opcode: " << ip->opcode();
+          break;
+
+        case kInstAltMatch:
+          // The list continues with the alternatives themselves.
+          ABSL_DCHECK(!ip->last());
+          break;
+
+        case kInstFail:
+          break;
+
+        case kInstByteRange:
+          mask |= uint64_t{1} << pos[id];
+          break;
+
+        case kInstCapture:
+        case kInstNop:
+          stk->push_back(ip->out());
+          break;
+
+        case kInstEmptyWidth:
+          if ((ip->empty() & ~flags) == 0)
+            stk->push_back(ip->out());
+          break;
+
+        case kInstMatch:
+          mask |= kMatchBit;
+          break;
+      }
+      if (ip->last())
+        break;
+    }
+  }
+  return mask;
+}
+
+// Layout of the tables in bit_parallel_, in units of uint64_t:
+//
+//   bytemask[256]           positions that accept each byte
+//   combo[kEmptyAllFlags+1] combination index for each set of kEmpty* flags
+//   kind[8]                 kind of each byte, packed two bits per byte
+//   pair[16]                combination index for each pair of byte kinds
+//   start[ncombo]           closure of the start instruction
+//   follow[ncombo][nchunk][256]
+//                           closure of the positions in each 8-bit chunk
+//
+// The "kind" of a byte says whether it is a word character and whether
+// it is a newline, which is all that the kEmpty* flags between two bytes
+// depend on.  pair is indexed by kind(before) << 2 | kind(after).
+static const int kByteMaskOffset = 0;
+static const int kComboOffset = kByteMaskOffset + 256;
+static const int kKindOffset = kComboOffset + kEmptyAllFlags + 1;
+static const int kPairOffset = kKindOffset + 256 / 32;
+static const int kStartOffset = kPairOffset + 16;
+
+// Returns the kEmpty* flags that prog uses.
+static uint32_t EmptyFlagsUsed(Prog* prog) {
+  uint32_t empty = 0;
+  for (int id = 0; id < prog->size(); id++) {
+    Prog::Inst* ip = prog->inst(id);
+    if (ip->opcode() == kInstEmptyWidth)
+      empty |= ip->empty();
+  }
+  return empty;
+}
+
+bool Prog::CanBitParallel() {
+  if (did_bit_parallel_)
+    return bit_parallel_combos_ != 0;
+  did_bit_parallel_ = true;
+
+  if (start() == 0)  // no match
+    return false;
+  // The simulation only ever runs forward.  (It could run backward,
+  // but the reverse program is only used to find where matches start,
+  // which needs the DFA or the NFA anyway.)
+  if (reversed_)
+    return false;
+
+  int npos = inst_count(kInstByteRange);
+  if (npos > kMaxBitParallelPositions)
+    return false;
+
+  // There is one closure per combination of the kEmpty* flags used.
+  uint32_t empty = EmptyFlagsUsed(this);
+  int nflag = 0;
+  for (uint32_t f = 1; f <= kEmptyAllFlags; f <<= 1) {
+    if (empty & f)
+      nflag++;
+  }
+  int ncombo = 1 << nflag;
+
+  // Steal memory for the tables from the overall DFA budget.
+  // Willing to use at most 1/4 of the DFA budget (heuristic),
+  // which is the same share that IsOnePass() is willing to use.
+  int nchunk = (npos + 7) / 8;
+  int64_t nword = kStartOffset + ncombo + int64_t{ncombo} * nchunk * 256;
+  if (dfa_mem_ / 4 / static_cast<int64_t>(sizeof(uint64_t)) < nword)
+    return false;
+
+  // The memory is set aside now, while nothing else can be using the
+  // budget, but the tables are built only when first searched: many
+  // RE2s are never asked anything that the simulation can answer.
+  dfa_mem_ -= nword * sizeof(uint64_t);
+  bit_parallel_chunks_ = nchunk;
+  bit_parallel_combos_ = ncombo;
+  return true;
+}
+
+void Prog::BuildBitParallel() {
+  int npos = inst_count(kInstByteRange);
+  uint32_t empty = EmptyFlagsUsed(this);
+  int nchunk = bit_parallel_chunks_;
+  int ncombo = bit_parallel_combos_;
+  int64_t nword = kStartOffset + ncombo + int64_t{ncombo} * nchunk * 256;
+
+  // Number the positions.
+  std::vector<int> pos(size(), -1);
+  std::vector<int> byteranges;
+  byteranges.reserve(npos);
+  for (int id = 0; id < size(); id++) {
+    if (inst(id)->opcode() == kInstByteRange) {
+      pos[id] = static_cast<int>(byteranges.size());
+      byteranges.push_back(id);
+    }
+  }
+  ABSL_DCHECK_EQ(byteranges.size(), static_cast<size_t>(npos));
+
+  PODArray<uint64_t> tables(static_cast<int>(nword));
+  uint64_t* bytemask = tables.data() + kByteMaskOffset;
+  uint64_t* combomap = tables.data() + kComboOffset;
+  uint64_t* kindmap = tables.data() + kKindOffset;
+  uint64_t* pairmap = tables.data() + kPairOffset;
+  uint64_t* startmask = tables.data() + kStartOffset;
+  uint64_t* follow = startmask + ncombo;
+
+  for (int c = 0; c < 256; c++) {
+    uint64_t mask = 0;
+    for (int id : byteranges) {
+      if (inst(id)->Matches(c))
+        mask |= uint64_t{1} << pos[id];
+    }
+    bytemask[c] = mask;
+  }
+
+  // Map each set of flags to the index of its combination:
+  // the flags that the program uses, packed into the low bits.
+  for (uint32_t flags = 0; flags <= kEmptyAllFlags; flags++) {
+    int combo = 0;
+    int bit = 0;
+    for (uint32_t f = 1; f <= kEmptyAllFlags; f <<= 1) {
+      if (empty & f) {
+        if (flags & f)
+          combo |= 1 << bit;
+        bit++;
+      }
+    }
+    combomap[flags] = combo;
+  }
+  for (int c = 0; c < 256; c++) {
+    if (c % 32 == 0)
+      kindmap[c / 32] = 0;
+    uint64_t kind = (c == '\n') << 1 | IsWordChar(static_cast<uint8_t>(c));
+    kindmap[c / 32] |= kind << (c % 32 * 2);
+  }
+  for (int before = 0; before < 4; before++) {
+    for (int after = 0; after < 4; after++) {
+      // Two bytes of these kinds: newline is not a word character,
+      // so kind 3 is impossible, but it costs nothing to fill in.
+      char text[2] = {(before & 2) ? '\n' : (before & 1) ? 'a' : ' ',
+                      (after & 2) ? '\n' : (after & 1) ? 'a' : ' '};
+      absl::string_view context(text, 2);
+      pairmap[before << 2 | after] = combomap[EmptyFlags(context, text + 1)];
+    }
+  }
+
+  SparseSet visited(size());
+  std::vector<int> stk;
+  std::vector<uint64_t> next(npos);
+  for (int combo = 0; combo < ncombo; combo++) {
+    // Recover the flags for this combination.
+    uint32_t flags = 0;
+    int bit = 0;
+    for (uint32_t f = 1; f <= kEmptyAllFlags; f <<= 1) {
+      if (empty & f) {
+        if (combo & (1 << bit))
+          flags |= f;
+        bit++;
+      }
+    }
+
+    startmask[combo] = Closure(this, start(), flags, pos.data(),
+                               &visited, &stk);
+    for (int id : byteranges)
+      next[pos[id]] = Closure(this, inst(id)->out(), flags, pos.data(),
+                              &visited, &stk);
+
+    // Each table entry is the union of the entry without its lowest bit
+    // and the closure of the position that the lowest bit stands for.
+    uint64_t* t = follow + int64_t{combo} * nchunk * 256;
+    for (int i = 0; i < nchunk; i++, t += 256) {
+      t[0] = 0;
+      for (int b = 1; b < 256; b++) {
+        int j = 0;
+        while ((b & (1 << j)) == 0)
+          j++;
+        int p = 8*i + j;
+        t[b] = t[b & (b-1)] | (p < npos ? next[p] : 0);
+      }
+    }
+  }
+
+  bit_parallel_ = std::move(tables);
+}
+
+bool Prog::SearchBitParallel(absl::string_view text, absl::string_view context,
+                             Anchor anchor, MatchKind kind,
+                             absl::string_view* match0) {
+  ABSL_DCHECK(CanBitParallel());
+  absl::call_once(bit_parallel_once_, [](Prog* prog) {
+    prog->BuildBitParallel();
+  }, this);
+
+  if (context.data() == NULL)
+    context = text;
+  if (anchor_start() && BeginPtr(context) != BeginPtr(text))
+    return false;
+  if (anchor_end() && EndPtr(context) != EndPtr(text))
+    return false;
+
+  bool anchored = anchor == kAnchored || anchor_start() || kind == kFullMatch;
+  bool endmatch = kind == kFullMatch || anchor_end();
+  if (kind == kManyMatch) {
+    ABSL_LOG(DFATAL) << "SearchBitParallel does not support kManyMatch";
+    return false;
+  }
+  if (match0 != NULL && (!anchored || kind == kFirstMatch)) {
+    ABSL_LOG(DFATAL) << "SearchBitParallel can only report the end of "
+                     << "an anchored kLongestMatch or kFullMatch";
+    return false;
+  }
+  // Unless the caller wants to know where the match ends or it must end
+  // at the end of the text, we can stop at the very first match we find.
+  bool want_earliest_match = match0 == NULL && !endmatch;
+
+  const int nchunk = bit_parallel_chunks_;
+  const int ncombo = bit_parallel_combos_;
+  const uint64_t* bytemask = bit_parallel_.data() + kByteMaskOffset;
+  const uint64_t* combomap = bit_parallel_.data() + kComboOffset;
+  const uint64_t* kindmap = bit_parallel_.data() + kKindOffset;
+  const uint64_t* pairmap = bit_parallel_.data() + kPairOffset;
+  const uint64_t* startmask = bit_parallel_.data() + kStartOffset;
+  const uint64_t* follow = startmask + ncombo;
+  const bool need_flags = ncombo > 1;
+  const bool can_prefix_accel = !anchored && this->can_prefix_accel();
+
+  const uint8_t* bp = reinterpret_cast<const uint8_t*>(text.data());
+  const uint8_t* p = bp;
+  const uint8_t* ep = bp + text.size();
+  const uint8_t* econtext =
+      reinterpret_cast<const uint8_t*>(context.data()) + context.size();
+  bool matched = false;
+  const uint8_t* lastmatch = NULL;
+
+  // Returns the index of the combination of flags in effect at p,
+  // which is after the beginning of the context.
+  auto combo_at = [&](const uint8_t* p) -> size_t {
+    if (!need_flags)
+      return 0;
+    if (p == econtext)
+      return combomap[EmptyFlags(context, reinterpret_cast<const char*>(p))];
+    auto kind = [&](uint8_t c) {
+      return (kindmap[c / 32] >> (c % 32 * 2)) & 3;
+    };
+    return pairmap[kind(p[-1]) << 2 | kind(p[0])];
+  };
+
+  size_t combo = 0;
+  if (need_flags)
+    combo = combomap[EmptyFlags(context, text.data())];
+  uint64_t d = startmask[combo];
+  for (;;) {
+    if (d & kMatchBit) {
+      if (want_earliest_match)
+        return true;
+      matched = true;
+      lastmatch = p;
+    }
+    if (p == ep)
+      break;
+
+    uint64_t m = d & bytemask[*p++];
+    if (m == 0) {
+      if (anchored)
+        break;
+      // Only the start state remains.  If the regexp begins with
+      // a literal prefix, skip ahead to its next likely occurrence.
+      // (A regexp with a prefix cannot match the empty string, so
+      // nothing can match at the positions skipped.)
+      if (can_prefix_accel && p < ep) {
+        p = reinterpret_cast<const uint8_t*>(
+            PrefixAccel(p, static_cast<size_t>(ep - p)));
+        if (p == NULL)
+          break;
+      }
+      d = startmask[combo_at(p)];
+      continue;
+    }
+
+    combo = combo_at(p);
+    const uint64_t* t = follow + combo * nchunk * 256;
+    d = 0;
+    for (int i = 0; i < nchunk; i++, t += 256, m >>= 8)
+      d |= t[m & 0xFF];
+    if (!anchored)
+      d |= startmask[combo];
+    else if (d == 0)
+      break;
+  }
+
+  if (!matched || (endmatch && lastmatch != ep))
+    return false;
+  if (match0 != NULL)
+    *match0 = absl::string_view(text.data(),
+                                static_cast<size_t>(lastmatch - bp));
+  return true;
+}
+
+}  // namespace re2
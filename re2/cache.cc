@@ -0,0 +1,103 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re2/cache.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "re2/re2.h"
+
+namespace re2 {
+
+RE2::Cache::Cache(size_t max_size)
+    : max_size_(max_size),
+      stats_{0, 0, 0, 0} {
+  ABSL_CHECK_GT(max_size_, size_t{0});
+}
+
+RE2::Cache::~Cache() {}
+
+RE2::Cache* RE2::Cache::Global() {
+  static Cache* const global = new Cache(1024);
+  return global;
+}
+
+RE2::Cache::Key RE2::Cache::MakeKey(absl::string_view pattern,
+                                    const RE2::Options& options) {
+  int bits = options.encoding();
+  bits = bits << 1 | options.posix_syntax();
+  bits = bits << 1 | options.longest_match();
+  bits = bits << 1 | options.log_errors();
+  bits = bits << 1 | options.literal();
+  bits = bits << 1 | options.never_nl();
+  bits = bits << 1 | options.dot_nl();
+  bits = bits << 1 | options.never_capture();
+  bits = bits << 1 | options.case_sensitive();
+  bits = bits << 1 | options.perl_classes();
+  bits = bits << 1 | options.word_boundary();
+  bits = bits << 1 | options.one_line();
+  return Key(std::string(pattern), options.max_mem(), bits);
+}
+
+std::shared_ptr<const RE2> RE2::Cache::Get(absl::string_view pattern,
+                                           const RE2::Options& options) {
+  Key key = MakeKey(pattern, options);
+  {
+    absl::MutexLock l(&mutex_);
+    auto it = map_.find(key);
+    if (it != map_.end()) {
+      stats_.hits++;
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return it->second->second;
+    }
+    stats_.misses++;
+  }
+
+  // Construct the RE2 object without holding the lock, which would stall
+  // every other caller (including those that would hit) for a long time.
+  // If another thread does the same meanwhile, whichever finishes first
+  // gets into the cache and the other one's work is discarded.
+  std::shared_ptr<const RE2> re = std::make_shared<const RE2>(pattern, options);
+
+  std::shared_ptr<const RE2> evicted;  // destroyed after unlocking
+  absl::MutexLock l(&mutex_);
+  auto it = map_.find(key);
+  if (it != map_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->second;
+  }
+  lru_.emplace_front(key, re);
+  map_.emplace(std::move(key), lru_.begin());
+  if (lru_.size() > max_size_) {
+    evicted = std::move(lru_.back().second);
+    map_.erase(lru_.back().first);
+    lru_.pop_back();
+    stats_.evictions++;
+  }
+  return re;
+}
+
+RE2::Cache::Stats RE2::Cache::stats() const {
+  absl::MutexLock l(&mutex_);
+  Stats stats = stats_;
+  stats.size = lru_.size();
+  return stats;
+}
+
+void RE2::Cache::Clear() {
+  std::list<Entry> lru;  // destroyed after unlocking
+  absl::MutexLock l(&mutex_);
+  map_.clear();
+  lru.swap(lru_);
+}
+
+}  // namespace re2
@@ -0,0 +1,94 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef RE2_CACHE_H_
+#define RE2_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "re2/re2.h"
+
+namespace re2 {
+
+// An RE2::Cache hands out RE2 objects for (pattern, options) pairs,
+// constructing each one only once for as long as it stays in the cache.
+// Since an RE2 object is immutable and thread-safe, one compiled program
+// (and the DFA states that it builds up as it is used) can then be shared
+// by any number of callers instead of each of them paying for its own.
+//
+// The cache holds at most max_size RE2 objects and evicts the least
+// recently used one to make room for another.  An evicted RE2 object
+// lives on for as long as some caller still holds it.
+//
+// Example:
+//
+//    std::shared_ptr<const RE2> re =
+//        RE2::Cache::Global()->Get("(\\w+):(\\d+)", RE2::Quiet);
+//    if (re->ok() && RE2::FullMatch(text, *re, &name, &port)) { ... }
+//
+// All methods are thread-safe.
+class RE2::Cache {
+ public:
+  struct Stats {
+    int64_t hits;       // calls to Get() that found the RE2 in the cache
+    int64_t misses;     // calls to Get() that had to construct it
+    int64_t evictions;  // RE2 objects evicted to make room for others
+    size_t size;        // RE2 objects currently in the cache
+  };
+
+  explicit Cache(size_t max_size);
+  ~Cache();
+
+  // Not copyable or movable.
+  Cache(const Cache&) = delete;
+  Cache& operator=(const Cache&) = delete;
+
+  // Returns the process-wide cache, which holds up to 1024 RE2 objects.
+  // It is never destroyed.
+  static Cache* Global();
+
+  // Returns the RE2 object for pattern and options, constructing it if
+  // it isn't in the cache.  Like constructing it directly, the pattern
+  // might fail to parse or compile, so the caller should check ok().
+  // Objects that failed are cached too so that the work isn't repeated.
+  std::shared_ptr<const RE2> Get(absl::string_view pattern,
+                                 const RE2::Options& options);
+
+  // Returns counts of hits, misses and evictions so far.
+  Stats stats() const;
+
+  // Removes everything from the cache.  Does not reset the stats.
+  void Clear();
+
+ private:
+  // The pattern, the maximum memory and the other options packed.
+  typedef std::tuple<std::string, int64_t, int> Key;
+  typedef std::pair<Key, std::shared_ptr<const RE2>> Entry;
+
+  static Key MakeKey(absl::string_view pattern, const RE2::Options& options);
+
+  const size_t max_size_;
+
+  mutable absl::Mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> lru_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<Key, std::list<Entry>::iterator> map_
+      ABSL_GUARDED_BY(mutex_);
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace re2
+
+#endif  // RE2_CACHE_H_
@@ -11,13 +11,18 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/base/attributes.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "re2/pod_array.h"
 #include "re2/prog.h"
 #include "re2/re2.h"
@@ -90,6 +95,79 @@ struct Frag {
       : begin(begin), end(end), nullable(nullable) {}
 };
 
+// Compiled fragment for a character class, as kept in the global cache.
+// The instructions are numbered from zero; the out (and, for an Alt, out1)
+// fields point at other instructions in the fragment, except for those
+// listed in end (as PatchList entries), which are left to be patched.
+struct CharClassFrag {
+  uint32_t begin;
+  std::vector<Prog::Inst> inst;
+  std::vector<uint32_t> end;
+};
+
+// Compiling a large character class for UTF-8 -- \p{L} has hundreds of
+// ranges -- costs far more than copying the instructions that result, and
+// the same few classes tend to turn up in pattern after pattern.  So the
+// fragments for such classes are kept in a process-wide cache, keyed by
+// the ranges and the direction of compilation.  Fragments are immutable
+// and never evicted; once the cache holds kMaxInst instructions, further
+// classes are simply compiled every time.
+class CharClassCache {
+ public:
+  static CharClassCache* Global() {
+    static CharClassCache* const global = new CharClassCache;
+    return global;
+  }
+
+  // Only classes with at least this many ranges, not all of them ASCII,
+  // are worth the lookup.
+  static bool Cacheable(CharClass* cc) {
+    return cc->end() - cc->begin() >= 8 && cc->end()[-1].hi >= Runeself;
+  }
+
+  static std::string MakeKey(CharClass* cc, bool reversed) {
+    std::string key;
+    key.reserve(1 + 8*(cc->end() - cc->begin()));
+    key.push_back(static_cast<char>(reversed << 1 | cc->FoldsASCII()));
+    for (CharClass::iterator i = cc->begin(); i != cc->end(); ++i) {
+      key.append(reinterpret_cast<const char*>(&i->lo), sizeof i->lo);
+      key.append(reinterpret_cast<const char*>(&i->hi), sizeof i->hi);
+    }
+    return key;
+  }
+
+  // Returns the fragment for key or NULL if there is none.
+  // The fragment lives for as long as the process does.
+  const CharClassFrag* Find(const std::string& key) {
+    absl::ReaderMutexLock l(&mutex_);
+    auto it = map_.find(key);
+    if (it == map_.end())
+      return NULL;
+    return it->second.get();
+  }
+
+  // Adds the fragment for key unless the cache is full.
+  // Another thread might have added it first, in which case f is dropped.
+  void Add(const std::string& key, std::unique_ptr<CharClassFrag> f) {
+    absl::MutexLock l(&mutex_);
+    size_t n = f->inst.size();
+    if (ninst_ + n > kMaxInst)
+      return;
+    if (map_.try_emplace(key, std::move(f)).second)
+      ninst_ += n;
+  }
+
+ private:
+  static const size_t kMaxInst = 1<<18;  // 2 MiB of instructions
+
+  CharClassCache() : ninst_(0) {}
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<const CharClassFrag>> map_
+      ABSL_GUARDED_BY(mutex_);
+  size_t ninst_ ABSL_GUARDED_BY(mutex_);
+};
+
 // Input encodings.
 enum Encoding {
   kEncodingUTF8 = 1,  // UTF-8 (0-10FFFF)
@@ -105,7 +183,10 @@ class Compiler : public Regexp::Walker<Frag> {
   // Caller is responsible for deleting Prog when finished with it.
   // If reversed is true, compiles for walking over the input
   // string backward (reverses all concatenations).
-  static Prog *Compile(Regexp* re, bool reversed, int64_t max_mem);
+  // If cap_map is not NULL, renumbers the capturing groups as described
+  // for Regexp::CompileToProgWithCaptures().
+  static Prog *Compile(Regexp* re, bool reversed, int64_t max_mem,
+                       const std::vector<int>* cap_map);
 
   // Compiles alternation of all the re to a new Prog.
   // Each re has a match with an id equal to its index in the vector.
@@ -194,6 +275,13 @@ class Compiler : public Regexp::Walker<Frag> {
   // Returns the alternation of all the added suffixes.
   Frag EndRange();
 
+  // Copies the instructions [begin, ninst_) that make up f, which was just
+  // compiled, into a new cache fragment.  Returns NULL if f can't be cached.
+  std::unique_ptr<CharClassFrag> SaveCharClass(int begin, Frag f);
+
+  // Copies the cached fragment f into the program and returns it.
+  Frag LoadCharClass(const CharClassFrag& f);
+
   // Single rune.
   Frag Literal(Rune r, bool foldcase);
 
@@ -208,6 +296,8 @@ class Compiler : public Regexp::Walker<Frag> {
   bool failed_;        // Did we give up compiling?
   Encoding encoding_;  // Input encoding
   bool reversed_;      // Should program run backward over text?
+  bool captures_;      // Will anything but the DFA run the program?
+  const std::vector<int>* cap_map_;  // Renumbers the capturing groups
 
   PODArray<Prog::Inst> inst_;
   int ninst_;          // Number of instructions used.
@@ -229,6 +319,8 @@ Compiler::Compiler() {
   failed_ = false;
   encoding_ = kEncodingUTF8;
   reversed_ = false;
+  captures_ = true;
+  cap_map_ = NULL;
   ninst_ = 0;
   max_ninst_ = 1;  // make AllocInst for fail instruction okay
   max_mem_ = 0;
@@ -624,6 +716,80 @@ Frag Compiler::EndRange() {
   return rune_range_;
 }
 
+std::unique_ptr<CharClassFrag> Compiler::SaveCharClass(int begin, Frag f) {
+  if (failed_ || static_cast<int>(f.begin) < begin)
+    return NULL;
+
+  std::unique_ptr<CharClassFrag> cf(new CharClassFrag);
+  cf->begin = f.begin - begin;
+  cf->inst.assign(inst_.data() + begin, inst_.data() + ninst_);
+  for (uint32_t p = f.end.head; p != 0; ) {
+    if (static_cast<int>(p>>1) < begin)
+      return NULL;
+    cf->end.push_back(p - (begin<<1));
+    Prog::Inst* ip = &cf->inst[(p>>1) - begin];
+    if (p&1) {
+      p = ip->out1();
+      ip->out1_ = 0;
+    } else {
+      p = ip->out();
+      ip->set_out(0);
+    }
+  }
+
+  // Renumber everything else, which must point within the fragment.
+  // The slots on the patch list are now zero, so they are left alone.
+  for (Prog::Inst& inst : cf->inst) {
+    switch (inst.opcode()) {
+      default:
+        return NULL;
+      case kInstAlt:
+        if (inst.out1() != 0) {
+          if (inst.out1() < begin)
+            return NULL;
+          inst.out1_ -= begin;
+        }
+        ABSL_FALLTHROUGH_INTENDED;
+      case kInstByteRange:
+        if (inst.out() != 0) {
+          if (inst.out() < begin)
+            return NULL;
+          inst.set_out(inst.out() - begin);
+        }
+        break;
+    }
+  }
+  return cf;
+}
+
+Frag Compiler::LoadCharClass(const CharClassFrag& f) {
+  int n = static_cast<int>(f.inst.size());
+  int base = AllocInst(n);
+  if (base < 0)
+    return NoMatch();
+  memmove(inst_.data() + base, f.inst.data(), n*sizeof inst_[0]);
+
+  // As above, but in reverse: a zero slot is either on the patch list or
+  // points at the first instruction of the fragment, so renumber all of
+  // them, then clear the slots on the patch list and string them together.
+  for (int i = base; i < base+n; i++) {
+    Prog::Inst* ip = &inst_[i];
+    if (ip->opcode() == kInstAlt)
+      ip->out1_ += base;
+    ip->set_out(ip->out() + base);
+  }
+  PatchList end = kNullPatchList;
+  for (uint32_t p : f.end) {
+    p += base<<1;
+    if (p&1)
+      inst_[p>>1].out1_ = 0;
+    else
+      inst_[p>>1].set_out(0);
+    end = PatchList::Append(inst_.data(), end, PatchList::Mk(p));
+  }
+  return Frag(f.begin + base, end, false);
+}
+
 // Converts rune range lo-hi into a fragment that recognizes
 // the bytes that would make up those runes in the current
 // encoding (Latin 1 or UTF-8).
@@ -933,8 +1099,19 @@ Frag Compiler::PostVisit(Regexp* re, Frag, Frag, Frag* child_frags,
       // (?i)abc from 3 insts per letter to 1 per letter.
       bool foldascii = cc->FoldsASCII();
 
+      // Large classes are compiled for UTF-8 only once per process
+      // and then copied.  See CharClassCache above.
+      std::string key;
+      if (encoding_ == kEncodingUTF8 && CharClassCache::Cacheable(cc)) {
+        key = CharClassCache::MakeKey(cc, reversed_);
+        const CharClassFrag* f = CharClassCache::Global()->Find(key);
+        if (f != NULL)
+          return LoadCharClass(*f);
+      }
+
       // Character class is just a big OR of the different
       // character ranges in the class.
+      int begin = ninst_;
       BeginRange();
       for (CharClass::iterator i = cc->begin(); i != cc->end(); ++i) {
         // ASCII case-folding optimization (see above).
@@ -950,14 +1127,28 @@ Frag Compiler::PostVisit(Regexp* re, Frag, Frag, Frag* child_frags,
 
         AddRuneRange(i->lo, i->hi, fold);
       }
-      return EndRange();
+      Frag f = EndRange();
+      if (!key.empty()) {
+        std::unique_ptr<CharClassFrag> cf = SaveCharClass(begin, f);
+        if (cf != NULL)
+          CharClassCache::Global()->Add(key, std::move(cf));
+      }
+      return f;
     }
 
     case kRegexpCapture:
       // If this is a non-capturing parenthesis -- (?:foo) --
-      // just use the inner expression.
-      if (re->cap() < 0)
+      // just use the inner expression.  Likewise if the program
+      // is only for the DFA, which doesn't track submatches.
+      if (re->cap() < 0 || !captures_)
         return child_frags[0];
+      if (cap_map_ != NULL) {
+        // Likewise if the caller doesn't want this group.
+        int cap = (*cap_map_)[re->cap()];
+        if (cap <= 0)
+          return child_frags[0];
+        return Capture(child_frags[0], cap);
+      }
       return Capture(child_frags[0], re->cap());
 
     case kRegexpBeginLine:
@@ -1112,10 +1303,14 @@ void Compiler::Setup(Regexp::ParseFlags flags, int64_t max_mem,
 // If reversed is true, compiles a program that expects
 // to run over the input string backward (reverses all concatenations).
 // The reversed flag is also recorded in the returned program.
-Prog* Compiler::Compile(Regexp* re, bool reversed, int64_t max_mem) {
+Prog* Compiler::Compile(Regexp* re, bool reversed, int64_t max_mem,
+                        const std::vector<int>* cap_map) {
   Compiler c;
   c.Setup(re->parse_flags(), max_mem, RE2::UNANCHORED /* unused */);
   c.reversed_ = reversed;
+  // The reverse program is only ever run by the DFA.
+  c.captures_ = !reversed;
+  c.cap_map_ = cap_map;
 
   // Simplify to remove things like counted repetitions
   // and character classes like \d.
@@ -1204,11 +1399,16 @@ Prog* Compiler::Finish(Regexp* re) {
 
 // Converts Regexp to Prog.
 Prog* Regexp::CompileToProg(int64_t max_mem) {
-  return Compiler::Compile(this, false, max_mem);
+  return Compiler::Compile(this, false, max_mem, NULL);
 }
 
 Prog* Regexp::CompileToReverseProg(int64_t max_mem) {
-  return Compiler::Compile(this, true, max_mem);
+  return Compiler::Compile(this, true, max_mem, NULL);
+}
+
+Prog* Regexp::CompileToProgWithCaptures(const std::vector<int>& cap_map,
+                                        int64_t max_mem) {
+  return Compiler::Compile(this, false, max_mem, &cap_map);
 }
 
 Frag Compiler::DotStar() {
@@ -1219,6 +1419,8 @@ Frag Compiler::DotStar() {
 Prog* Compiler::CompileSet(Regexp* re, RE2::Anchor anchor, int64_t max_mem) {
   Compiler c;
   c.Setup(re->parse_flags(), max_mem, anchor);
+  // The program is only ever run by the DFA.
+  c.captures_ = false;
 
   Regexp* sre = re->Simplify();
   if (sre == NULL)
@@ -107,11 +107,32 @@ class DFA {
               bool want_earliest_match, bool run_forward, bool* failed,
               const char** ep, SparseSet* matches);
 
+  // Searches for successive matches, as for Prog::SearchDFASuccessive(),
+  // taking the cache lock once for all of them.
+  int SearchSuccessive(absl::string_view text, absl::string_view context,
+                       const char* lastend, absl::string_view* matches,
+                       int nmatches, bool* skip, bool* failed);
+
+  // Runs an anchored search on each of matches[0, n), setting it to
+  // the span that the search covered, taking the cache lock once
+  // for all of them.  Returns whether every one of them matched.
+  bool SearchAnchoredEach(absl::string_view context,
+                          absl::string_view* matches, int n, bool* failed);
+
+  // Searches text split into chunks[0, nchunks), which is the context,
+  // from offset begin to offset end as though the chunks were one string.
+  // Otherwise like Search(), but sets *ep to an offset, not a pointer.
+  bool SearchChunks(const absl::string_view* chunks, int nchunks,
+                    size_t begin, size_t end, bool anchored,
+                    bool want_earliest_match, bool run_forward,
+                    bool* failed, size_t* ep);
+
   // Builds out all states for the entire DFA.
   // If cb is not empty, it receives one callback per state built.
+  // If max_states is positive, building more states than that
+  // counts as running out of memory.
   // Returns the number of states built.
-  // FOR TESTING OR EXPERIMENTAL PURPOSES ONLY.
-  int BuildAllStates(const Prog::DFAStateCallback& cb);
+  int BuildAllStates(const Prog::DFAStateCallback& cb, int max_states);
 
   // Computes min and max for matching strings.  Won't return strings
   // bigger than maxlen.
@@ -254,9 +275,14 @@ class DFA {
         want_earliest_match(false),
         run_forward(false),
         start(NULL),
+        chunks(&this->text),
+        nchunks(1),
+        begin(0),
+        end(text.size()),
+        lastbyte(kByteEndText),
         cache_lock(cache_lock),
         failed(false),
-        ep(NULL),
+        ep(0),
         matches(NULL) {}
 
     absl::string_view text;
@@ -266,9 +292,18 @@ class DFA {
     bool want_earliest_match;
     bool run_forward;
     State* start;
+    // The search loop scans chunks[0, nchunks) from offset begin to
+    // offset end as though they were one string; by default, the only
+    // chunk is text.  lastbyte is the byte just past that span in the
+    // direction of the search, or kByteEndText if there is none.
+    const absl::string_view* chunks;
+    int nchunks;
+    size_t begin;
+    size_t end;
+    int lastbyte;
     RWLocker* cache_lock;
     bool failed;     // "out" parameter: whether search gave up
-    const char* ep;  // "out" parameter: end pointer for match
+    size_t ep;       // "out" parameter: end offset for match
     SparseSet* matches;
 
    private:
@@ -283,14 +318,27 @@ class DFA {
     std::atomic<State*> start;
   };
 
-  // Fills in params->start and params->can_prefix_accel using
-  // the other search parameters.  Returns true on success,
+  // Fills in params->start, params->lastbyte and params->can_prefix_accel
+  // using the other search parameters.  Returns true on success,
   // false on failure.
   // cache_mutex_.r <= L < mutex_
   bool AnalyzeSearch(SearchParams* params);
+  // Like AnalyzeSearch, but given the byte c that comes just before
+  // the text in the direction of the search (or kByteEndText if none)
+  // instead of finding it in the context, and leaving params->lastbyte
+  // to the caller.
+  bool AnalyzeSearch(SearchParams* params, int c);
   bool AnalyzeSearchHelper(SearchParams* params, StartInfo* info,
                            uint32_t flags);
 
+  // Does the work of Search() with the cache locked by cache_lock.
+  // cache_mutex_.r <= L < mutex_
+  // Might unlock and relock cache_mutex_ via cache_lock.
+  bool SearchLocked(RWLocker* cache_lock, absl::string_view text,
+                    absl::string_view context, bool anchored,
+                    bool want_earliest_match, bool run_forward,
+                    bool* failed, const char** ep, SparseSet* matches);
+
   // The generic search loop, inlined to create specialized versions.
   // cache_mutex_.r <= L < mutex_
   // Might unlock and relock cache_mutex_ via params->cache_lock.
@@ -1347,28 +1395,30 @@ DFA::State* DFA::StateSaver::Restore() {
 // When s->next[c]->IsMatch(), it means that there is a match ending just
 // *before* byte c.
 
-// The generic search loop.  Searches text for a match, returning
-// the pointer to the end of the chosen match, or NULL if no match.
+// The generic search loop.  Searches the text for a match, setting
+// params->ep to the offset of the end of the chosen match.
 // The bools are equal to the same-named variables in params, but
 // making them function arguments lets the inliner specialize
 // this function to each combination (see two paragraphs above).
+//
+// The text is usually in one piece, but SearchChunks() passes it as
+// several, so the loop runs over the chunks and keeps track of the
+// matching position as an offset.  Within each chunk, it scans bytes
+// exactly as it would if that chunk were all there was.
 template <bool can_prefix_accel,
           bool want_earliest_match,
           bool run_forward>
 inline bool DFA::InlinedSearchLoop(SearchParams* params) {
   State* start = params->start;
-  const uint8_t* bp = BytePtr(params->text.data());  // start of text
-  const uint8_t* p = bp;                             // text scanning point
-  const uint8_t* ep = BytePtr(params->text.data() +
-                              params->text.size());  // end of text
-  const uint8_t* resetp = NULL;                      // p at last cache reset
-  if (!run_forward) {
-    using std::swap;
-    swap(p, ep);
-  }
+  const absl::string_view* chunks = params->chunks;
+  int nchunks = params->nchunks;
+  size_t begin = params->begin;  // start of text
+  size_t end = params->end;      // end of text
+  bool reset = false;            // whether this search has reset the cache
+  size_t resetpos = 0;           // position at last cache reset
 
   const uint8_t* bytemap = prog_->bytemap();
-  const uint8_t* lastmatch = NULL;   // most recent matching position in text
+  size_t lastmatch = 0;     // most recent matching position in text
   bool matched = false;
 
   State* s = start;
@@ -1377,7 +1427,7 @@ inline bool DFA::InlinedSearchLoop(SearchParams* params) {
 
   if (s->IsMatch()) {
     matched = true;
-    lastmatch = p;
+    lastmatch = run_forward ? begin : end;
     if (ExtraDebug)
       absl::FPrintF(stderr, "match @stx! [%s]\n", DumpState(s));
     if (params->matches != NULL) {
@@ -1389,126 +1439,170 @@ inline bool DFA::InlinedSearchLoop(SearchParams* params) {
       }
     }
     if (want_earliest_match) {
-      params->ep = reinterpret_cast<const char*>(lastmatch);
+      params->ep = lastmatch;
       return true;
     }
   }
 
-  while (p != ep) {
-    if (ExtraDebug)
-      absl::FPrintF(stderr, "@%d: %s\n", p - bp, DumpState(s));
-
-    if (can_prefix_accel && s == start) {
-      // In start state, only way out is to find the prefix,
-      // so we use prefix accel (e.g. memchr) to skip ahead.
-      // If not found, we can skip to the end of the string.
-      p = BytePtr(prog_->PrefixAccel(p, ep - p));
-      if (p == NULL) {
-        p = ep;
-        break;
-      }
+  // Visit the chunks in the direction of the search, skipping whatever
+  // of each lies outside the text.
+  size_t next = 0;
+  if (!run_forward) {
+    for (int i = 0; i < nchunks; i++)
+      next += chunks[i].size();
+  }
+  for (int n = 0; n < nchunks; n++) {
+    int i = run_forward ? n : nchunks-1 - n;
+    size_t off;  // offset of chunk i
+    if (run_forward) {
+      off = next;
+      next += chunks[i].size();
+    } else {
+      next -= chunks[i].size();
+      off = next;
     }
+    size_t lo = std::max(begin, off);
+    size_t hi = std::min(end, off + chunks[i].size());
+    if (lo >= hi)
+      continue;
 
-    int c;
-    if (run_forward)
-      c = *p++;
-    else
-      c = *--p;
-
-    // Note that multiple threads might be consulting
-    // s->next_[bytemap[c]] simultaneously.
-    // RunStateOnByte takes care of the appropriate locking,
-    // including a memory barrier so that the unlocked access
-    // (sometimes known as "double-checked locking") is safe.
-    // The alternative would be either one DFA per thread
-    // or one mutex operation per input byte.
-    //
-    // ns == DeadState means the state is known to be dead
-    // (no more matches are possible).
-    // ns == NULL means the state has not yet been computed
-    // (need to call RunStateOnByteUnlocked).
-    // RunStateOnByte returns ns == NULL if it is out of memory.
-    // ns == FullMatchState means the rest of the string matches.
-    //
-    // Okay to use bytemap[] not ByteMap() here, because
-    // c is known to be an actual byte and not kByteEndText.
-
-    State* ns = s->next_[bytemap[c]].load(std::memory_order_acquire);
-    if (ns == NULL) {
-      ns = RunStateOnByteUnlocked(s, c);
-      if (ns == NULL) {
-        // After we reset the cache, we hold cache_mutex exclusively,
-        // so if resetp != NULL, it means we filled the DFA state
-        // cache with this search alone (without any other threads).
-        // Benchmarks show that doing a state computation on every
-        // byte runs at about 0.2 MB/s, while the NFA (nfa.cc) can do the
-        // same at about 2 MB/s.  Unless we're processing an average
-        // of 10 bytes per state computation, fail so that RE2 can
-        // fall back to the NFA.  However, RE2::Set cannot fall back,
-        // so we just have to keep on keeping on in that case.
-        if (dfa_should_bail_when_slow && resetp != NULL &&
-            static_cast<size_t>(p - resetp) < 10*state_cache_.size() &&
-            kind_ != Prog::kManyMatch) {
-          params->failed = true;
-          return false;
-        }
-        resetp = p;
-
-        // Prepare to save start and s across the reset.
-        StateSaver save_start(this, start);
-        StateSaver save_s(this, s);
-
-        // Discard all the States in the cache.
-        ResetCache(params->cache_lock);
+    const uint8_t* bp = BytePtr(chunks[i].data());  // start of chunk
+    const uint8_t* p = bp + (lo - off);             // text scanning point
+    const uint8_t* ep = bp + (hi - off);            // end of text in chunk
+    if (!run_forward) {
+      using std::swap;
+      swap(p, ep);
+    }
+    // Whether the text ends in this chunk.
+    bool last = run_forward ? hi == end : lo == begin;
 
-        // Restore start and s so we can continue.
-        if ((start = save_start.Restore()) == NULL ||
-            (s = save_s.Restore()) == NULL) {
-          // Restore already did ABSL_LOG(DFATAL).
-          params->failed = true;
-          return false;
-        }
-        ns = RunStateOnByteUnlocked(s, c);
-        if (ns == NULL) {
-          ABSL_LOG(DFATAL) << "RunStateOnByteUnlocked failed after ResetCache";
-          params->failed = true;
-          return false;
+    while (p != ep) {
+      if (ExtraDebug)
+        absl::FPrintF(stderr, "@%d: %s\n", off + (p - bp), DumpState(s));
+
+      if (can_prefix_accel && s == start) {
+        // In start state, only way out is to find the prefix,
+        // so we use prefix accel (e.g. memchr) to skip ahead.
+        // If not found, we can skip to the end of the string,
+        // or else to where a prefix could continue into the next chunk.
+        const uint8_t* q = BytePtr(prog_->PrefixAccel(p, ep - p));
+        if (q != NULL) {
+          p = q;
+        } else if (last) {
+          p = ep;
+          break;
+        } else {
+          p = ep - std::min(static_cast<size_t>(ep - p),
+                            prog_->prefix_size() - 1);
+          if (p == ep)
+            break;
         }
       }
-    }
-    if (ns <= SpecialStateMax) {
-      if (ns == DeadState) {
-        params->ep = reinterpret_cast<const char*>(lastmatch);
-        return matched;
-      }
-      // FullMatchState
-      params->ep = reinterpret_cast<const char*>(ep);
-      return true;
-    }
 
-    s = ns;
-    if (s->IsMatch()) {
-      matched = true;
-      // The DFA notices the match one byte late,
-      // so adjust p before using it in the match.
+      int c;
       if (run_forward)
-        lastmatch = p - 1;
+        c = *p++;
       else
-        lastmatch = p + 1;
-      if (ExtraDebug)
-        absl::FPrintF(stderr, "match @%d! [%s]\n", lastmatch - bp, DumpState(s));
-      if (params->matches != NULL) {
-        for (int i = s->ninst_ - 1; i >= 0; i--) {
-          int id = s->inst_[i];
-          if (id == MatchSep)
-            break;
-          params->matches->insert(id);
+        c = *--p;
+
+      // Note that multiple threads might be consulting
+      // s->next_[bytemap[c]] simultaneously.
+      // RunStateOnByte takes care of the appropriate locking,
+      // including a memory barrier so that the unlocked access
+      // (sometimes known as "double-checked locking") is safe.
+      // The alternative would be either one DFA per thread
+      // or one mutex operation per input byte.
+      //
+      // ns == DeadState means the state is known to be dead
+      // (no more matches are possible).
+      // ns == NULL means the state has not yet been computed
+      // (need to call RunStateOnByteUnlocked).
+      // RunStateOnByte returns ns == NULL if it is out of memory.
+      // ns == FullMatchState means the rest of the string matches.
+      //
+      // Okay to use bytemap[] not ByteMap() here, because
+      // c is known to be an actual byte and not kByteEndText.
+
+      State* ns = s->next_[bytemap[c]].load(std::memory_order_acquire);
+      if (ns == NULL) {
+        ns = RunStateOnByteUnlocked(s, c);
+        if (ns == NULL) {
+          // After we reset the cache, we hold cache_mutex exclusively,
+          // so if reset is true, it means we filled the DFA state
+          // cache with this search alone (without any other threads).
+          // Benchmarks show that doing a state computation on every
+          // byte runs at about 0.2 MB/s, while the NFA (nfa.cc) can do the
+          // same at about 2 MB/s.  Unless we're processing an average
+          // of 10 bytes per state computation, fail so that RE2 can
+          // fall back to the NFA.  However, RE2::Set cannot fall back,
+          // so we just have to keep on keeping on in that case.
+          size_t pos = off + static_cast<size_t>(p - bp);
+          if (dfa_should_bail_when_slow && reset &&
+              pos - resetpos < 10*state_cache_.size() &&
+              kind_ != Prog::kManyMatch) {
+            params->failed = true;
+            return false;
+          }
+          reset = true;
+          resetpos = pos;
+
+          // Prepare to save start and s across the reset.
+          StateSaver save_start(this, start);
+          StateSaver save_s(this, s);
+
+          // Discard all the States in the cache.
+          ResetCache(params->cache_lock);
+
+          // Restore start and s so we can continue.
+          if ((start = save_start.Restore()) == NULL ||
+              (s = save_s.Restore()) == NULL) {
+            // Restore already did ABSL_LOG(DFATAL).
+            params->failed = true;
+            return false;
+          }
+          ns = RunStateOnByteUnlocked(s, c);
+          if (ns == NULL) {
+            ABSL_LOG(DFATAL) << "RunStateOnByteUnlocked failed after ResetCache";
+            params->failed = true;
+            return false;
+          }
         }
       }
-      if (want_earliest_match) {
-        params->ep = reinterpret_cast<const char*>(lastmatch);
+      if (ns <= SpecialStateMax) {
+        if (ns == DeadState) {
+          params->ep = lastmatch;
+          return matched;
+        }
+        // FullMatchState
+        params->ep = run_forward ? end : begin;
         return true;
       }
+
+      s = ns;
+      if (s->IsMatch()) {
+        matched = true;
+        // The DFA notices the match one byte late,
+        // so adjust p before using it in the match.
+        lastmatch = off + static_cast<size_t>(p - bp);
+        if (run_forward)
+          lastmatch--;
+        else
+          lastmatch++;
+        if (ExtraDebug)
+          absl::FPrintF(stderr, "match @%d! [%s]\n", lastmatch, DumpState(s));
+        if (params->matches != NULL) {
+          for (int i = s->ninst_ - 1; i >= 0; i--) {
+            int id = s->inst_[i];
+            if (id == MatchSep)
+              break;
+            params->matches->insert(id);
+          }
+        }
+        if (want_earliest_match) {
+          params->ep = lastmatch;
+          return true;
+        }
+      }
     }
   }
 
@@ -1517,19 +1611,7 @@ inline bool DFA::InlinedSearchLoop(SearchParams* params) {
   if (ExtraDebug)
     absl::FPrintF(stderr, "@etx: %s\n", DumpState(s));
 
-  int lastbyte;
-  if (run_forward) {
-    if (EndPtr(params->text) == EndPtr(params->context))
-      lastbyte = kByteEndText;
-    else
-      lastbyte = EndPtr(params->text)[0] & 0xFF;
-  } else {
-    if (BeginPtr(params->text) == BeginPtr(params->context))
-      lastbyte = kByteEndText;
-    else
-      lastbyte = BeginPtr(params->text)[-1] & 0xFF;
-  }
-
+  int lastbyte = params->lastbyte;
   State* ns = s->next_[ByteMap(lastbyte)].load(std::memory_order_acquire);
   if (ns == NULL) {
     ns = RunStateOnByteUnlocked(s, lastbyte);
@@ -1550,18 +1632,18 @@ inline bool DFA::InlinedSearchLoop(SearchParams* params) {
   }
   if (ns <= SpecialStateMax) {
     if (ns == DeadState) {
-      params->ep = reinterpret_cast<const char*>(lastmatch);
+      params->ep = lastmatch;
       return matched;
     }
     // FullMatchState
-    params->ep = reinterpret_cast<const char*>(ep);
+    params->ep = run_forward ? end : begin;
     return true;
   }
 
   s = ns;
   if (s->IsMatch()) {
     matched = true;
-    lastmatch = p;
+    lastmatch = run_forward ? end : begin;
     if (ExtraDebug)
       absl::FPrintF(stderr, "match @etx! [%s]\n", DumpState(s));
     if (params->matches != NULL) {
@@ -1574,7 +1656,7 @@ inline bool DFA::InlinedSearchLoop(SearchParams* params) {
     }
   }
 
-  params->ep = reinterpret_cast<const char*>(lastmatch);
+  params->ep = lastmatch;
   return matched;
 }
 
@@ -1664,37 +1746,35 @@ bool DFA::AnalyzeSearch(SearchParams* params) {
     return true;
   }
 
+  int before = BeginPtr(text) == BeginPtr(context) ?
+               kByteEndText : BeginPtr(text)[-1] & 0xFF;
+  int after = EndPtr(text) == EndPtr(context) ?
+              kByteEndText : EndPtr(text)[0] & 0xFF;
+  if (params->run_forward) {
+    params->lastbyte = after;
+    return AnalyzeSearch(params, before);
+  } else {
+    params->lastbyte = before;
+    return AnalyzeSearch(params, after);
+  }
+}
+
+bool DFA::AnalyzeSearch(SearchParams* params, int c) {
   // Determine correct search type.
   int start;
   uint32_t flags;
-  if (params->run_forward) {
-    if (BeginPtr(text) == BeginPtr(context)) {
-      start = kStartBeginText;
-      flags = kEmptyBeginText|kEmptyBeginLine;
-    } else if (BeginPtr(text)[-1] == '\n') {
-      start = kStartBeginLine;
-      flags = kEmptyBeginLine;
-    } else if (Prog::IsWordChar(BeginPtr(text)[-1] & 0xFF)) {
-      start = kStartAfterWordChar;
-      flags = kFlagLastWord;
-    } else {
-      start = kStartAfterNonWordChar;
-      flags = 0;
-    }
+  if (c == kByteEndText) {
+    start = kStartBeginText;
+    flags = kEmptyBeginText|kEmptyBeginLine;
+  } else if (c == '\n') {
+    start = kStartBeginLine;
+    flags = kEmptyBeginLine;
+  } else if (Prog::IsWordChar(static_cast<uint8_t>(c))) {
+    start = kStartAfterWordChar;
+    flags = kFlagLastWord;
   } else {
-    if (EndPtr(text) == EndPtr(context)) {
-      start = kStartBeginText;
-      flags = kEmptyBeginText|kEmptyBeginLine;
-    } else if (EndPtr(text)[0] == '\n') {
-      start = kStartBeginLine;
-      flags = kEmptyBeginLine;
-    } else if (Prog::IsWordChar(EndPtr(text)[0] & 0xFF)) {
-      start = kStartAfterWordChar;
-      flags = kFlagLastWord;
-    } else {
-      start = kStartAfterNonWordChar;
-      flags = 0;
-    }
+    start = kStartAfterNonWordChar;
+    flags = 0;
   }
   if (params->anchored)
     start |= kStartAnchored;
@@ -1776,7 +1856,17 @@ bool DFA::Search(absl::string_view text, absl::string_view context,
   }
 
   RWLocker l(&cache_mutex_);
-  SearchParams params(text, context, &l);
+  return SearchLocked(&l, text, context, anchored, want_earliest_match,
+                      run_forward, failed, epp, matches);
+}
+
+bool DFA::SearchLocked(RWLocker* cache_lock, absl::string_view text,
+                       absl::string_view context, bool anchored,
+                       bool want_earliest_match, bool run_forward,
+                       bool* failed, const char** epp, SparseSet* matches) {
+  *epp = NULL;
+  *failed = false;
+  SearchParams params(text, context, cache_lock);
   params.anchored = anchored;
   params.want_earliest_match = want_earliest_match;
   params.run_forward = run_forward;
@@ -1799,6 +1889,129 @@ bool DFA::Search(absl::string_view text, absl::string_view context,
   }
   if (ExtraDebug)
     absl::FPrintF(stderr, "start %s\n", DumpState(params.start));
+  bool ret = FastSearchLoop(&params);
+  if (params.failed) {
+    *failed = true;
+    return false;
+  }
+  if (ret)
+    *epp = text.data() + params.ep;
+  return ret;
+}
+
+int DFA::SearchSuccessive(absl::string_view text, absl::string_view context,
+                          const char* lastend, absl::string_view* matches,
+                          int nmatches, bool* skip, bool* failed) {
+  *skip = false;
+  if (!ok()) {
+    *failed = true;
+    return 0;
+  }
+  *failed = false;
+
+  RWLocker l(&cache_mutex_);
+  const char* p = text.data();
+  const char* ep = text.data() + text.size();
+  int n = 0;
+  while (n < nmatches) {
+    const char* end;
+    if (!SearchLocked(&l, absl::string_view(p, static_cast<size_t>(ep - p)),
+                      context, false, false, true, failed, &end, NULL))
+      break;
+    if (end == lastend) {
+      *skip = true;
+      break;
+    }
+    matches[n++] = absl::string_view(p, static_cast<size_t>(end - p));
+    p = lastend = end;
+  }
+  return n;
+}
+
+bool DFA::SearchAnchoredEach(absl::string_view context,
+                             absl::string_view* matches, int n,
+                             bool* failed) {
+  if (!ok()) {
+    *failed = true;
+    return false;
+  }
+  *failed = false;
+
+  RWLocker l(&cache_mutex_);
+  bool run_forward = !prog_->reversed();
+  for (int i = 0; i < n; i++) {
+    const char* ep;
+    if (!SearchLocked(&l, matches[i], context, true, false, run_forward,
+                      failed, &ep, NULL))
+      return false;
+    if (run_forward)
+      matches[i] = absl::string_view(
+          matches[i].data(), static_cast<size_t>(ep - matches[i].data()));
+    else
+      matches[i] = absl::string_view(
+          ep, static_cast<size_t>(matches[i].data() + matches[i].size() - ep));
+  }
+  return true;
+}
+
+// Returns the byte at offset pos in the concatenation of chunks[0, nchunks).
+static int ChunkByte(const absl::string_view* chunks, int nchunks,
+                     size_t pos) {
+  for (int i = 0; i < nchunks; i++) {
+    if (pos < chunks[i].size())
+      return chunks[i][pos] & 0xFF;
+    pos -= chunks[i].size();
+  }
+  ABSL_LOG(DFATAL) << "offset is past the end of the chunks";
+  return 0;
+}
+
+// Like SearchLocked, but the search loop gets the chunks rather than text,
+// and the bytes around the text are found in the chunks, not the context.
+bool DFA::SearchChunks(const absl::string_view* chunks, int nchunks,
+                       size_t begin, size_t end, bool anchored,
+                       bool want_earliest_match, bool run_forward,
+                       bool* failed, size_t* epp) {
+  *epp = 0;
+  if (!ok()) {
+    *failed = true;
+    return false;
+  }
+  *failed = false;
+
+  size_t size = 0;
+  for (int i = 0; i < nchunks; i++)
+    size += chunks[i].size();
+  if (begin > end || end > size) {
+    ABSL_LOG(DFATAL) << "context does not contain text";
+    return false;
+  }
+  // The bytes on either side of the text, which set the flags for
+  // the empty-width assertions at the start and at the end.
+  int before = begin > 0 ? ChunkByte(chunks, nchunks, begin-1) : kByteEndText;
+  int after = end < size ? ChunkByte(chunks, nchunks, end) : kByteEndText;
+
+  RWLocker l(&cache_mutex_);
+  SearchParams params(absl::string_view(), absl::string_view(), &l);
+  params.anchored = anchored;
+  params.want_earliest_match = want_earliest_match;
+  params.run_forward = run_forward;
+  params.chunks = chunks;
+  params.nchunks = nchunks;
+  params.begin = begin;
+  params.end = end;
+  params.lastbyte = run_forward ? after : before;
+  if (!AnalyzeSearch(&params, run_forward ? before : after)) {
+    *failed = true;
+    return false;
+  }
+  if (params.start == DeadState)
+    return false;
+  if (params.start == FullMatchState) {
+    *epp = run_forward == want_earliest_match ? begin : end;
+    return true;
+  }
+
   bool ret = FastSearchLoop(&params);
   if (params.failed) {
     *failed = true;
@@ -1900,11 +2113,15 @@ bool Prog::SearchDFA(absl::string_view text, absl::string_view context,
                              want_earliest_match, !reversed_,
                              failed, &ep, matches);
   if (*failed) {
+    dfa_failures_.fetch_add(1, std::memory_order_relaxed);
     hooks::GetDFASearchFailureHook()({
         // Nothing yet...
     });
     return false;
   }
+  // Avoid writing to the shared cache line unless necessary.
+  if (dfa_failures_.load(std::memory_order_relaxed) != 0)
+    dfa_failures_.store(0, std::memory_order_relaxed);
   if (!matched)
     return false;
   if (endmatch && ep != (reversed_ ? text.data() : text.data() + text.size()))
@@ -1924,8 +2141,117 @@ bool Prog::SearchDFA(absl::string_view text, absl::string_view context,
   return true;
 }
 
+int Prog::SearchDFASuccessive(absl::string_view text,
+                              absl::string_view context, MatchKind kind,
+                              const char* lastend, absl::string_view* matches,
+                              int nmatches, bool* skip, bool* failed) {
+  ABSL_DCHECK(!reversed_ && !anchor_start() && !anchor_end());
+  ABSL_DCHECK(kind == kFirstMatch || kind == kLongestMatch);
+  if (context.data() == NULL)
+    context = text;
+  DFA* dfa = GetDFA(kind);
+  int n = dfa->SearchSuccessive(text, context, lastend, matches, nmatches,
+                                skip, failed);
+  if (*failed) {
+    dfa_failures_.fetch_add(1, std::memory_order_relaxed);
+    hooks::GetDFASearchFailureHook()({
+        // Nothing yet...
+    });
+    return 0;
+  }
+  if (dfa_failures_.load(std::memory_order_relaxed) != 0)
+    dfa_failures_.store(0, std::memory_order_relaxed);
+  return n;
+}
+
+bool Prog::SearchDFAAnchoredEach(absl::string_view context,
+                                 absl::string_view* matches, int n,
+                                 bool* failed) {
+  ABSL_DCHECK(!anchor_start() && !anchor_end());
+  DFA* dfa = GetDFA(kLongestMatch);
+  bool matched = dfa->SearchAnchoredEach(context, matches, n, failed);
+  if (*failed) {
+    dfa_failures_.fetch_add(1, std::memory_order_relaxed);
+    hooks::GetDFASearchFailureHook()({
+        // Nothing yet...
+    });
+    return false;
+  }
+  if (dfa_failures_.load(std::memory_order_relaxed) != 0)
+    dfa_failures_.store(0, std::memory_order_relaxed);
+  return matched;
+}
+
+bool Prog::SearchDFAChunks(const absl::string_view* chunks, int nchunks,
+                           size_t begin, size_t end, Anchor anchor,
+                           MatchKind kind, size_t* ep, bool* failed) {
+  ABSL_DCHECK(kind != kManyMatch);
+  *failed = false;
+
+  size_t size = 0;
+  for (int i = 0; i < nchunks; i++)
+    size += chunks[i].size();
+  bool caret = anchor_start();
+  bool dollar = anchor_end();
+  if (reversed_) {
+    using std::swap;
+    swap(caret, dollar);
+  }
+  if (caret && begin != 0)
+    return false;
+  if (dollar && end != size)
+    return false;
+
+  // As in SearchDFA().
+  bool anchored = anchor == kAnchored || anchor_start() || kind == kFullMatch;
+  bool endmatch = false;
+  if (kind == kFullMatch || anchor_end()) {
+    endmatch = true;
+    kind = kLongestMatch;
+  }
+  bool want_earliest_match = false;
+  if (ep == NULL && !endmatch) {
+    want_earliest_match = true;
+    kind = kLongestMatch;
+  }
+
+  DFA* dfa = GetDFA(kind);
+  size_t pos;
+  bool matched = dfa->SearchChunks(chunks, nchunks, begin, end, anchored,
+                                   want_earliest_match, !reversed_,
+                                   failed, &pos);
+  if (*failed) {
+    dfa_failures_.fetch_add(1, std::memory_order_relaxed);
+    hooks::GetDFASearchFailureHook()({
+        // Nothing yet...
+    });
+    return false;
+  }
+  if (dfa_failures_.load(std::memory_order_relaxed) != 0)
+    dfa_failures_.store(0, std::memory_order_relaxed);
+  if (!matched)
+    return false;
+  if (endmatch && pos != (reversed_ ? begin : end))
+    return false;
+  if (ep != NULL)
+    *ep = pos;
+  return true;
+}
+
+// After this many failed searches in a row, the DFA is skipped
+// for all but one in every kDFARetryInterval searches.
+static const int kMaxDFAFailures = 3;
+static const int kDFARetryInterval = 64;
+
+bool Prog::ShouldSkipDFA() {
+  if (dfa_failures_.load(std::memory_order_relaxed) < kMaxDFAFailures)
+    return false;
+  int n = dfa_skips_.fetch_add(1, std::memory_order_relaxed);
+  return n % kDFARetryInterval != kDFARetryInterval - 1;
+}
+
 // Build out all states in DFA.  Returns number of states.
-int DFA::BuildAllStates(const Prog::DFAStateCallback& cb) {
+int DFA::BuildAllStates(const Prog::DFAStateCallback& cb, int max_states) {
   if (!ok())
     return 0;
 
@@ -1977,6 +2303,10 @@ int DFA::BuildAllStates(const Prog::DFAStateCallback& cb) {
         continue;
       }
       if (m.find(ns) == m.end()) {
+        if (max_states > 0 && static_cast<int>(m.size()) >= max_states) {
+          oom = true;
+          break;
+        }
         m.emplace(ns, static_cast<int>(m.size()));
         q.push_back(ns);
       }
@@ -1994,7 +2324,182 @@ int DFA::BuildAllStates(const Prog::DFAStateCallback& cb) {
 
 // Build out all states in DFA for kind.  Returns number of states.
 int Prog::BuildEntireDFA(MatchKind kind, const DFAStateCallback& cb) {
-  return GetDFA(kind)->BuildAllStates(cb);
+  return GetDFA(kind)->BuildAllStates(cb, 0);
+}
+
+// The entire DFA, flattened into a table for SearchFlatDFA.  Each state is
+// a row of bytemap_range()+1 pointers to the rows of the next states, so
+// that stepping to the next state is a single load, as it is in the cache.
+// The matching states come after all of the others and the dead state comes
+// last, so that a single comparison catches both matching and dying.
+struct Prog::FlatDFA {
+  typedef const void* const* State;
+
+  PODArray<const void*> next;  // rows of next states
+  State start;                 // start state
+  State match;                 // first matching state (or the dead state)
+  State dead;                  // dead state
+};
+
+// Flat DFAs bigger than this don't fit nicely in the cache.
+static const int kMaxFlatDFASize = 1<<13;
+
+bool Prog::ReserveFlatDFA() {
+  if (flat_dfa_max_size_ > 0)
+    return true;
+
+  // Willing to use at most 1/4 of the DFA budget (heuristic), which is
+  // the same share that IsOnePass() and CanBitParallel() are willing to use.
+  // Without room for a few states, the table isn't worth having.
+  int64_t size = std::min(int64_t{kMaxFlatDFASize},
+                          dfa_mem_ / 4 / int64_t{sizeof(void*)});
+  if (size / (bytemap_range() + 1) < 4)
+    return false;
+  dfa_mem_ -= size * sizeof(void*);
+  flat_dfa_max_size_ = static_cast<int>(size);
+  return true;
+}
+
+Prog::FlatDFA* Prog::GetFlatDFA() {
+  absl::call_once(flat_dfa_once_, [](Prog* prog) {
+    int nnext = prog->bytemap_range() + 1;
+    std::vector<int> next;
+    std::vector<bool> match;
+    bool oom = false;
+    // SearchDFA uses the longest match DFA when the caller doesn't care
+    // where the match is, so share its states.  With an end anchor, only
+    // the end of the text leads to a matching state.
+    prog->GetDFA(kLongestMatch)->BuildAllStates([&](const int* n, bool m) {
+      if (n == NULL) {
+        oom = true;
+        return;
+      }
+      next.insert(next.end(), n, n + nnext);
+      match.push_back(m);
+    }, prog->flat_dfa_max_size_ / nnext - 1);
+    if (oom || match.empty())
+      return;
+
+    // Lay out the states that don't match, then those that do,
+    // then the dead state.
+    int nstates = static_cast<int>(match.size());
+    std::vector<int> row(nstates);
+    int offset = 0;
+    for (int i = 0; i < nstates; i++) {
+      if (!match[i]) {
+        row[i] = offset;
+        offset += nnext;
+      }
+    }
+    int match_offset = offset;
+    for (int i = 0; i < nstates; i++) {
+      if (match[i]) {
+        row[i] = offset;
+        offset += nnext;
+      }
+    }
+    int dead_offset = offset;
+    offset += nnext;
+
+    FlatDFA* flat = new FlatDFA;
+    flat->next = PODArray<const void*>(offset);
+    const void** base = flat->next.data();
+    for (int i = 0; i < nstates; i++) {
+      for (int b = 0; b < nnext; b++) {
+        int n = next[i*nnext + b];
+        base[row[i] + b] = base + (n < 0 ? dead_offset : row[n]);
+      }
+    }
+    for (int b = 0; b < nnext; b++)
+      base[dead_offset + b] = base + dead_offset;
+    flat->start = base + row[0];
+    flat->match = base + match_offset;
+    flat->dead = base + dead_offset;
+    prog->flat_dfa_ = flat;
+  }, this);
+  return flat_dfa_;
+}
+
+void Prog::DeleteFlatDFA(FlatDFA* flat) {
+  delete flat;
+}
+
+void Prog::TESTING_ONLY_skip_flat_dfa_wait() {
+  flat_dfa_wait_.store(0, std::memory_order_relaxed);
+}
+
+// SearchFlatDFA charges the text that a program searches to flat_dfa_wait_
+// in batches of this many bytes, so that small searches don't all write to
+// the counter, which is shared by every thread.
+static const int64_t kFlatDFAWaitBatch = 4096;
+
+// Returns how much to charge for searching n bytes.  Below a batch, the
+// charge is a whole batch with probability n/kFlatDFAWaitBatch, else zero,
+// which comes to the same on average.
+static int64_t FlatDFAWaitCharge(size_t n) {
+  if (n >= static_cast<size_t>(kFlatDFAWaitBatch))
+    return static_cast<int64_t>(n);
+  // A xorshift generator: it need only be cheap, not good.
+  thread_local uint32_t x = 2463534242U;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return static_cast<size_t>(x % kFlatDFAWaitBatch) < n ? kFlatDFAWaitBatch : 0;
+}
+
+bool Prog::SearchFlatDFA(absl::string_view text, absl::string_view context,
+                         bool* matched) {
+  if (flat_dfa_max_size_ == 0)
+    return false;
+  if (context.data() == NULL)
+    context = text;
+  // The DFA was built for starting at the beginning of the context.
+  if (BeginPtr(text) != BeginPtr(context))
+    return false;
+  if (anchor_end() && EndPtr(text) != EndPtr(context)) {
+    *matched = false;
+    return true;
+  }
+
+  // Building out the entire DFA costs as much as searching quite a lot of
+  // text, so wait until this program has searched that much.  Thereafter,
+  // this is just one (cheap) load.
+  if (flat_dfa_wait_.load(std::memory_order_relaxed) > 0) {
+    int64_t charge = FlatDFAWaitCharge(text.size());
+    if (charge == 0 ||
+        flat_dfa_wait_.fetch_sub(charge, std::memory_order_relaxed) > charge)
+      return false;
+  }
+  FlatDFA* flat = GetFlatDFA();
+  if (flat == NULL)
+    return false;
+
+  typedef FlatDFA::State State;
+  const State match = flat->match;
+  const State dead = flat->dead;
+  State s = flat->start;
+  if (s >= match) {
+    *matched = true;
+    return true;
+  }
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(BeginPtr(text));
+  const uint8_t* ep = reinterpret_cast<const uint8_t*>(EndPtr(text));
+  for (; p < ep; p++) {
+    s = static_cast<State>(s[bytemap_[*p]]);
+    // Matches are seen one byte late, so a match ended before *p.
+    if (s >= match) {
+      *matched = s != dead;
+      return true;
+    }
+  }
+  // Process one more byte to see if it triggers a match.
+  // (Remember, matches are delayed one byte.)
+  if (EndPtr(text) == EndPtr(context))
+    s = static_cast<State>(s[bytemap_range_]);
+  else
+    s = static_cast<State>(s[bytemap_[*ep]]);
+  *matched = s >= match && s != dead;
+  return true;
 }
 
 // Computes min and max for matching string.
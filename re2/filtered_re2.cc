@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <cstdlib>
+#include <functional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -79,7 +80,49 @@ RE2::ErrorCode FilteredRE2::Add(absl::string_view pattern,
   return code;
 }
 
+void FilteredRE2::AddAll(const std::vector<absl::string_view>& patterns,
+                         const RE2::Options& options,
+                         const RE2::ParallelFor& parallel_for,
+                         std::vector<int>* ids,
+                         std::vector<RE2::ErrorCode>* codes) {
+  int npatterns = static_cast<int>(patterns.size());
+  std::vector<RE2*> res(npatterns);
+  parallel_for(npatterns, [&](int i) {
+    res[i] = new RE2(patterns[i], options);
+  });
+
+  // Assign the ids in order, just as Add() would.
+  if (ids != NULL)
+    ids->assign(npatterns, -1);
+  if (codes != NULL)
+    codes->assign(npatterns, RE2::NoError);
+  for (int i = 0; i < npatterns; i++) {
+    RE2* re = res[i];
+    if (codes != NULL)
+      (*codes)[i] = re->error_code();
+    if (!re->ok()) {
+      if (options.log_errors()) {
+        ABSL_LOG(ERROR) << "Couldn't compile regular expression, skipping: "
+                        << patterns[i] << " due to error " << re->error();
+      }
+      delete re;
+      continue;
+    }
+    if (ids != NULL)
+      (*ids)[i] = static_cast<int>(re2_vec_.size());
+    re2_vec_.push_back(re);
+  }
+}
+
 void FilteredRE2::Compile(std::vector<std::string>* atoms) {
+  Compile(atoms, [](int n, const std::function<void(int i)>& fn) {
+    for (int i = 0; i < n; i++)
+      fn(i);
+  });
+}
+
+void FilteredRE2::Compile(std::vector<std::string>* atoms,
+                          const RE2::ParallelFor& parallel_for) {
   if (compiled_) {
     ABSL_LOG(ERROR) << "Compile called already.";
     return;
@@ -90,10 +133,14 @@ void FilteredRE2::Compile(std::vector<std::string>* atoms) {
     return;
   }
 
-  for (size_t i = 0; i < re2_vec_.size(); i++) {
-    Prefilter* prefilter = Prefilter::FromRE2(re2_vec_[i]);
+  // Computing the prefilters is where the time goes, so do that in
+  // parallel, then add them to the tree in order.
+  std::vector<Prefilter*> prefilters(re2_vec_.size());
+  parallel_for(static_cast<int>(re2_vec_.size()), [&](int i) {
+    prefilters[i] = Prefilter::FromRE2(re2_vec_[i]);
+  });
+  for (Prefilter* prefilter : prefilters)
     prefilter_tree_->Add(prefilter);
-  }
   atoms->clear();
   prefilter_tree_->Compile(atoms);
   compiled_ = true;
@@ -52,6 +52,16 @@ class FilteredRE2 {
                      const RE2::Options& options,
                      int* id);
 
+  // Adds patterns as if by calling Add() on each of them in turn, but
+  // constructs the RE2 objects by way of parallel_for.  Fills ids (if not
+  // NULL) with the id of each regexp or -1 if it wasn't added and codes
+  // (if not NULL) with what Add() would have returned for each of them.
+  void AddAll(const std::vector<absl::string_view>& patterns,
+              const RE2::Options& options,
+              const RE2::ParallelFor& parallel_for,
+              std::vector<int>* ids,
+              std::vector<RE2::ErrorCode>* codes);
+
   // Prepares the regexps added by Add for filtering.  Returns a set
   // of strings that the caller should check for in candidate texts.
   // The returned strings are lowercased and distinct. When doing
@@ -60,6 +70,11 @@ class FilteredRE2 {
   // all Add calls are done.
   void Compile(std::vector<std::string>* strings_to_match);
 
+  // As above, but computes the prefilters for the regexps by way of
+  // parallel_for.  The result is the same.
+  void Compile(std::vector<std::string>* strings_to_match,
+               const RE2::ParallelFor& parallel_for);
+
   // Returns the index of the first matching regexp.
   // Returns -1 on no match. Can be called prior to Compile.
   // Does not do any filtering: simply tries to Match the
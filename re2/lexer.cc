@@ -0,0 +1,137 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re2/lexer.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/log/absl_log.h"
+#include "absl/strings/string_view.h"
+#include "re2/prog.h"
+#include "re2/re2.h"
+#include "re2/set.h"
+#include "re2/sparse_set.h"
+
+namespace re2 {
+
+RE2::Lexer::Lexer(const RE2::Options& options)
+    : options_(options),
+      compiled_(false) {
+  // Maximal munch wants the longest match of each of the regexps,
+  // which is also what the DFA finds for all of them together.
+  options_.set_longest_match(true);
+}
+
+RE2::Lexer::~Lexer() = default;
+
+int RE2::Lexer::Add(absl::string_view pattern, std::string* error) {
+  if (compiled_) {
+    ABSL_LOG(DFATAL) << "RE2::Lexer::Add() called after compiling";
+    return -1;
+  }
+
+  std::unique_ptr<RE2> re(new RE2(pattern, options_));
+  if (!re->ok()) {
+    if (error != NULL)
+      *error = re->error();
+    return -1;
+  }
+
+  int n = static_cast<int>(re_.size());
+  re_.push_back(std::move(re));
+  return n;
+}
+
+bool RE2::Lexer::Compile() {
+  if (compiled_) {
+    ABSL_LOG(DFATAL) << "RE2::Lexer::Compile() called more than once";
+    return false;
+  }
+  compiled_ = true;
+  if (re_.empty())
+    return true;
+
+  RE2::Set set(options_, RE2::ANCHOR_START);
+  for (size_t i = 0; i < re_.size(); i++) {
+    if (set.Add(re_[i]->pattern(), NULL) < 0)
+      return false;
+  }
+  if (!set.Compile())
+    return false;
+  prog_ = std::move(set.prog_);
+  return true;
+}
+
+int RE2::Lexer::Consume(absl::string_view* input, absl::string_view* submatch,
+                        int nsubmatch) const {
+  if (!compiled_) {
+    ABSL_LOG(DFATAL) << "RE2::Lexer::Consume() called before compiling";
+    return -1;
+  }
+  if (prog_ == nullptr)
+    return -1;
+
+  // One pass of the DFA finds the length of the longest match and which
+  // of the regexps match some prefix of *input along the way.
+  int size = static_cast<int>(re_.size());
+  SparseSet matches(size);
+  absl::string_view match;
+  bool dfa_failed = false;
+  if (!prog_->SearchDFA(*input, *input, Prog::kAnchored, Prog::kManyMatch,
+                        &match, &dfa_failed, &matches) &&
+      !dfa_failed)
+    return -1;
+
+  int token = -1;
+  absl::string_view m;
+  if (dfa_failed) {
+    // The DFA ran out of memory, so try each of the regexps in turn.
+    for (int i = 0; i < size; i++) {
+      if (re_[i]->Match(*input, 0, input->size(), RE2::ANCHOR_START, &m, 1) &&
+          (token < 0 || m.size() > match.size())) {
+        token = i;
+        match = m;
+      }
+    }
+    if (token < 0)
+      return -1;
+  } else if (matches.size() == 1) {
+    // The only one that matched must have matched the most.
+    token = *matches.begin();
+  } else {
+    // The first one added that matches as much as the DFA did wins.
+    std::sort(matches.begin(), matches.end(), matches.less);
+    for (int i : matches) {
+      if (re_[i]->Match(*input, 0, input->size(), RE2::ANCHOR_START, &m, 1) &&
+          m.size() == match.size()) {
+        token = i;
+        break;
+      }
+    }
+    if (token < 0) {
+      ABSL_LOG(DFATAL) << "RE2::Lexer inconsistency";
+      return -1;
+    }
+  }
+
+  if (nsubmatch > 1) {
+    if (!re_[token]->Match(*input, 0, input->size(), RE2::ANCHOR_START,
+                           submatch, nsubmatch) ||
+        submatch[0].size() != match.size()) {
+      ABSL_LOG(DFATAL) << "RE2::Lexer inconsistency";
+      return -1;
+    }
+  } else if (nsubmatch == 1) {
+    submatch[0] = match;
+  }
+  input->remove_prefix(match.size());
+  return token;
+}
+
+}  // namespace re2
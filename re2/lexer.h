@@ -0,0 +1,87 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef RE2_LEXER_H_
+#define RE2_LEXER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "re2/re2.h"
+
+namespace re2 {
+class Prog;
+}  // namespace re2
+
+namespace re2 {
+
+// An RE2::Lexer splits text into tokens, each of which matches one of a
+// list of regexps, by "maximal munch": at each position, the token is the
+// longest match of any of the regexps there, and where more than one of
+// them match that much, the one that was added first wins.  That is one
+// pass of an RE2::Set-style DFA per token, however many regexps there are,
+// instead of one Consume() per regexp.
+//
+//   RE2::Lexer lexer(RE2::DefaultOptions);
+//   lexer.Add("if|else|while", NULL);       // 0: keyword
+//   lexer.Add("[A-Za-z_]\\w*", NULL);       // 1: identifier
+//   lexer.Add("\\d+", NULL);                // 2: number
+//   lexer.Add("\\s+", NULL);                // 3: white space
+//   ABSL_CHECK(lexer.Compile());
+//
+//   absl::string_view token;
+//   int id;
+//   while ((id = lexer.Consume(&input, &token, 1)) >= 0) {
+//     ...
+//   }
+//
+// As with RE2::Consume(), each token is matched as though the text began
+// where it does.  Once compiled, a Lexer can be used from many threads at
+// once.
+class RE2::Lexer {
+ public:
+  explicit Lexer(const RE2::Options& options);
+  ~Lexer();
+
+  // Not copyable.
+  Lexer(const Lexer&) = delete;
+  Lexer& operator=(const Lexer&) = delete;
+
+  // Adds pattern to the lexer using the options passed to the constructor,
+  // except that longest_match is always set.  Returns the index of the
+  // token, or -1 if the regexp cannot be parsed, in which case *error
+  // (if error is not NULL) says why.
+  // Indices are assigned in sequential order starting from 0.
+  int Add(absl::string_view pattern, std::string* error);
+
+  // Compiles the lexer in preparation for consuming tokens.
+  // Returns false if the compiler runs out of memory.
+  // Add() must not be called again after Compile().
+  // Compile() must be called before Consume().
+  bool Compile();
+
+  // Consumes the token at the start of *input and returns its index, or
+  // returns -1 (and leaves *input alone) if none of the regexps match
+  // there.  Fills in submatch[0, nsubmatch) for the token as Match()
+  // would; the parenthesized groups are only worked out if asked for.
+  // Beware of regexps that can match the empty string, which consume
+  // nothing.
+  int Consume(absl::string_view* input, absl::string_view* submatch,
+              int nsubmatch) const;
+
+  // Returns the RE2 for the token with the given index.
+  const RE2& GetRE2(int index) const { return *re_[index]; }
+
+ private:
+  RE2::Options options_;
+  std::vector<std::unique_ptr<RE2>> re_;
+  bool compiled_;
+  std::unique_ptr<re2::Prog> prog_;  // says which tokens match where
+};
+
+}  // namespace re2
+
+#endif  // RE2_LEXER_H_
@@ -0,0 +1,234 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// Generates C++ source for a StaticDFA.  See static_dfa.h.
+//
+// Usage: make_static_dfa [flags] NAME PATTERN
+//
+//   --full_match         match the whole text, as for RE2::FullMatch()
+//   --case_insensitive   as for RE2::Options
+//   --latin1             as for RE2::Options
+//   --max_mem=N          as for RE2::Options
+//   --namespace=NS       define NAME in namespace NS (e.g. foo::bar)
+//   --output=FILE        write to FILE instead of stdout
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "re2/prog.h"
+#include "re2/re2.h"
+#include "re2/regexp.h"
+
+namespace re2 {
+
+static void Usage() {
+  fprintf(stderr,
+          "usage: make_static_dfa [--full_match] [--case_insensitive] "
+          "[--latin1] [--max_mem=N] [--namespace=NS] [--output=FILE] "
+          "NAME PATTERN\n");
+  exit(2);
+}
+
+static bool IsIdentifier(absl::string_view s) {
+  if (s.empty() || absl::ascii_isdigit(s[0]))
+    return false;
+  for (char c : s) {
+    if (!absl::ascii_isalnum(c) && c != '_')
+      return false;
+  }
+  return true;
+}
+
+// Builds the DFA for re, filling in the tables as described in
+// static_dfa.h.  Returns false if the DFA exceeds the memory budget.
+static bool BuildTables(const RE2& re, int* nbytes,
+                        std::vector<uint8_t>* bytemap,
+                        std::vector<int32_t>* next, std::vector<bool>* match) {
+  // The same budget that RE2 gives to the forward Prog and its DFAs.
+  std::unique_ptr<Prog> prog(
+      re.Regexp()->CompileToProg(re.options().max_mem()*2/3));
+  if (prog == NULL)
+    return false;
+
+  *nbytes = prog->bytemap_range() + 1;
+  bytemap->assign(prog->bytemap(), prog->bytemap() + 256);
+  next->clear();
+  match->clear();
+  bool oom = false;
+  prog->BuildEntireDFA(Prog::kLongestMatch, [&](const int* n, bool m) {
+    if (n == NULL) {
+      oom = true;
+      return;
+    }
+    next->insert(next->end(), n, n + *nbytes);
+    match->push_back(m);
+  });
+  if (oom)
+    return false;
+
+  // The start state is dead if the pattern can't match anything.
+  if (match->empty()) {
+    next->assign(*nbytes, -1);
+    match->push_back(false);
+  }
+  return true;
+}
+
+static std::string Generate(const std::string& name, const std::string& ns,
+                            const std::string& pattern, bool full_match,
+                            int nbytes, const std::vector<uint8_t>& bytemap,
+                            const std::vector<int32_t>& next,
+                            const std::vector<bool>& match) {
+  std::vector<std::string> namespaces;
+  if (!ns.empty())
+    namespaces = absl::StrSplit(ns, "::");
+  std::string guard = "STATIC_DFA_";
+  for (const std::string& n : namespaces)
+    guard += absl::AsciiStrToUpper(n) + "_";
+  guard += absl::AsciiStrToUpper(name) + "_H_";
+
+  std::string s;
+  s += "// GENERATED BY make_static_dfa; DO NOT EDIT.\n";
+  s += absl::StrFormat("// Pattern: \"%s\"%s\n", absl::CEscape(pattern),
+                       full_match ? " (full match)" : "");
+  s += absl::StrFormat("// %d states, %d byte classes.\n\n",
+                       match.size(), nbytes - 1);
+  s += absl::StrFormat("#ifndef %s\n#define %s\n\n", guard, guard);
+  s += "#include <stdint.h>\n\n";
+  s += "#include \"re2/static_dfa.h\"\n\n";
+  for (const std::string& n : namespaces)
+    s += absl::StrFormat("namespace %s {\n", n);
+  if (!namespaces.empty())
+    s += "\n";
+
+  s += absl::StrFormat("inline const re2::StaticDFA& %s() {\n", name);
+  s += "  static constexpr uint8_t kByteMap[256] = {";
+  for (int c = 0; c < 256; c++)
+    s += absl::StrFormat("%s%d,", c%16 == 0 ? "\n    " : " ", bytemap[c]);
+  s += "\n  };\n";
+  s += absl::StrFormat("  static constexpr int32_t kNext[%d] = {",
+                       next.size());
+  for (size_t i = 0; i < next.size(); i++)
+    s += absl::StrFormat("%s%d,", i%nbytes == 0 ? "\n    " : " ", next[i]);
+  s += "\n  };\n";
+  s += absl::StrFormat("  static constexpr bool kMatch[%d] = {",
+                       match.size());
+  for (size_t i = 0; i < match.size(); i++)
+    s += absl::StrFormat("%s%s,", i%8 == 0 ? "\n    " : " ",
+                         match[i] ? "true" : "false");
+  s += "\n  };\n";
+  s += absl::StrFormat(
+      "  static constexpr re2::StaticDFA kDFA(kByteMap, %d, kNext, kMatch);\n",
+      nbytes);
+  s += "  return kDFA;\n";
+  s += "}\n";
+
+  if (!namespaces.empty())
+    s += "\n";
+  for (auto it = namespaces.rbegin(); it != namespaces.rend(); ++it)
+    s += absl::StrFormat("}  // namespace %s\n", *it);
+  s += absl::StrFormat("\n#endif  // %s\n", guard);
+  return s;
+}
+
+static int Main(int argc, char** argv) {
+  RE2::Options options;
+  bool full_match = false;
+  std::string ns;
+  std::string output;
+  std::vector<std::string> args;
+  for (int i = 1; i < argc; i++) {
+    absl::string_view arg = argv[i];
+    int64_t max_mem;
+    if (arg == "--full_match") {
+      full_match = true;
+    } else if (arg == "--case_insensitive") {
+      options.set_case_sensitive(false);
+    } else if (arg == "--latin1") {
+      options.set_encoding(RE2::Options::EncodingLatin1);
+    } else if (absl::ConsumePrefix(&arg, "--max_mem=")) {
+      if (!absl::SimpleAtoi(arg, &max_mem) || max_mem <= 0)
+        Usage();
+      options.set_max_mem(max_mem);
+    } else if (absl::ConsumePrefix(&arg, "--namespace=")) {
+      ns = std::string(arg);
+      for (absl::string_view n : absl::StrSplit(ns, "::")) {
+        if (!IsIdentifier(n))
+          Usage();
+      }
+    } else if (absl::ConsumePrefix(&arg, "--output=")) {
+      output = std::string(arg);
+    } else if (absl::StartsWith(arg, "--")) {
+      Usage();
+    } else {
+      args.emplace_back(arg);
+    }
+  }
+  if (args.size() != 2 || !IsIdentifier(args[0]))
+    Usage();
+  const std::string& name = args[0];
+  const std::string& pattern = args[1];
+
+  options.set_log_errors(false);
+  RE2 re(pattern, options);
+  if (!re.ok()) {
+    fprintf(stderr, "make_static_dfa: %s\n", re.error().c_str());
+    return 1;
+  }
+  // Having checked that the pattern parses on its own,
+  // anchoring it can't change its meaning.
+  std::unique_ptr<RE2> anchored;
+  if (full_match) {
+    anchored.reset(new RE2("\\A(?:" + pattern + ")\\z", options));
+    if (!anchored->ok()) {
+      fprintf(stderr, "make_static_dfa: %s\n", anchored->error().c_str());
+      return 1;
+    }
+  }
+
+  int nbytes;
+  std::vector<uint8_t> bytemap;
+  std::vector<int32_t> next;
+  std::vector<bool> match;
+  if (!BuildTables(full_match ? *anchored : re, &nbytes, &bytemap, &next,
+                   &match)) {
+    fprintf(stderr, "make_static_dfa: DFA out of memory; raise --max_mem\n");
+    return 1;
+  }
+  std::string code = Generate(name, ns, pattern, full_match, nbytes, bytemap,
+                              next, match);
+
+  FILE* f = stdout;
+  if (!output.empty()) {
+    f = fopen(output.c_str(), "w");
+    if (f == NULL) {
+      perror(output.c_str());
+      return 1;
+    }
+  }
+  if (fwrite(code.data(), 1, code.size(), f) != code.size() ||
+      (f != stdout && fclose(f) != 0)) {
+    perror(output.empty() ? "stdout" : output.c_str());
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace re2
+
+int main(int argc, char** argv) {
+  return re2::Main(argc, argv);
+}
@@ -89,6 +89,13 @@ class Regexp::ParseState {
   // Pushes the literal rune r onto the stack.
   bool PushLiteral(Rune r);
 
+  // Fast path for runs of literal text, which make up most of a
+  // machine-generated pattern: consumes the plain ASCII characters and
+  // escaped punctuation at the start of *s and pushes them onto the stack
+  // all at once, just as calling PushLiteral() for each would have done.
+  // Returns false, having consumed nothing, if there are fewer than two.
+  bool PushLiteralRun(absl::string_view* s);
+
   // Pushes a regexp with the given op (and no args) onto the stack.
   bool PushSimpleOp(RegexpOp op);
 
@@ -444,6 +451,83 @@ bool Regexp::ParseState::PushLiteral(Rune r) {
   return PushRegexp(re);
 }
 
+// Returns the length of the literal at the start of s if it is one that
+// PushLiteralRun() can handle, otherwise 0: an ASCII character that isn't
+// a metacharacter, or a backslash followed by ASCII punctuation; in neither
+// case letters under FoldCase nor a newline under NeverNL.
+static int LiteralRunLength(absl::string_view s, Regexp::ParseFlags flags) {
+  int n = 1;
+  int c = s[0] & 0xFF;
+  switch (c) {
+    case '.': case '+': case '*': case '?': case '(': case ')': case '|':
+    case '[': case ']': case '{': case '}': case '^': case '$':
+      return 0;
+    case '\\':
+      if (s.size() < 2 || absl::ascii_isalnum(s[1] & 0xFF))
+        return 0;
+      n = 2;
+      c = s[1] & 0xFF;
+      break;
+  }
+  if (c >= Runeself)
+    return 0;
+  if ((flags & Regexp::FoldCase) && absl::ascii_isalpha(c))
+    return 0;
+  if ((flags & Regexp::NeverNL) && c == '\n')
+    return 0;
+  return n;
+}
+
+bool Regexp::ParseState::PushLiteralRun(absl::string_view* s) {
+  // Find the run, leaving out its last literal if a repetition operator
+  // might follow, since that applies to the last literal alone.
+  absl::string_view t = *s;
+  int nrunes = 0;
+  size_t last = 0;
+  size_t end = 0;
+  while (end < t.size()) {
+    int n = LiteralRunLength(t.substr(end), flags_);
+    if (n == 0)
+      break;
+    last = end;
+    end += n;
+    nrunes++;
+  }
+  if (end < t.size()) {
+    switch (t[end]) {
+      case '*': case '+': case '?': case '{':
+        end = last;
+        nrunes--;
+        break;
+    }
+  }
+  if (nrunes < 2)
+    return false;
+  s->remove_prefix(end);
+
+  // Add to the literal on top of the stack if PushLiteral() would have,
+  // otherwise start a new one.
+  Regexp* re = stacktop_;
+  if (re == NULL ||
+      (re->op_ != kRegexpLiteral && re->op_ != kRegexpLiteralString) ||
+      (re->parse_flags_ & FoldCase) != (flags_ & FoldCase)) {
+    re = new Regexp(kRegexpLiteralString, flags_);
+    PushRegexp(re);
+  } else if (re->op_ == kRegexpLiteral) {
+    Rune r = re->rune_;
+    re->op_ = kRegexpLiteralString;
+    re->nrunes_ = 0;
+    re->runes_ = NULL;
+    re->AddRuneToString(r);
+  }
+  for (size_t i = 0; i < end; i++) {
+    if (t[i] == '\\')
+      i++;
+    re->AddRuneToString(t[i] & 0xFF);
+  }
+  return true;
+}
+
 // Pushes a ^ onto the stack.
 bool Regexp::ParseState::PushCaret() {
   if (flags_ & OneLine) {
@@ -2259,6 +2343,217 @@ void ConvertLatin1ToUTF8(absl::string_view latin1, std::string* utf) {
   }
 }
 
+namespace {
+
+// A word for ParseWords(), as runes folded to the least rune in their
+// orbit (if applicable) so that words that match the same strings are
+// equal, and its index in the list of words.
+struct Word {
+  std::vector<Rune> runes;
+  int index;
+};
+
+// Builds the trie of words for ParseWords().
+class WordTrieBuilder {
+ public:
+  WordTrieBuilder(bool longest_match, Regexp::ParseFlags flags)
+      : longest_match_(longest_match), flags_(flags) {}
+
+  // Returns the least rune in the case folding orbit of r, if any.
+  Rune Fold(Rune r);
+
+  // Returns a Regexp that matches the suffixes after depth of the words
+  // in [begin, end), which are sorted and distinct and have the first
+  // depth runes in common.  Reorders the words in the range.
+  Regexp* Build(const Word** begin, const Word** end, size_t depth);
+
+ private:
+  // Returns a Regexp that matches the suffixes after depth of the words
+  // in [begin, end), which are sorted and distinct and have a rune after
+  // the first depth runes, or NULL if the range is empty.
+  Regexp* BuildBranches(const Word** begin, const Word** end, size_t depth);
+
+  // Appends Regexps that match runes, which were folded by Fold(), to subs.
+  void AppendRunes(const Rune* runes, int nrunes, std::vector<Regexp*>* subs);
+
+  bool longest_match_;
+  Regexp::ParseFlags flags_;
+};
+
+Rune WordTrieBuilder::Fold(Rune r) {
+  if (!(flags_ & Regexp::FoldCase))
+    return r;
+  if (flags_ & Regexp::Latin1)
+    return ('a' <= r && r <= 'z') ? r + 'A' - 'a' : r;
+  Rune min = r;
+  for (Rune r1 = CycleFoldRune(r); r1 != r; r1 = CycleFoldRune(r1))
+    min = std::min(min, r1);
+  return min;
+}
+
+void WordTrieBuilder::AppendRunes(const Rune* runes, int nrunes,
+                                  std::vector<Regexp*>* subs) {
+  // Like the parser, match case-folded ASCII letters with FoldCase
+  // literals and other runes that fold with character classes.
+  // Runes that don't fold are left alone.
+  bool foldcase = (flags_ & Regexp::FoldCase) != 0;
+  bool latin1 = (flags_ & Regexp::Latin1) != 0;
+  std::vector<Rune> lit;
+  for (int i = 0; i <= nrunes; i++) {
+    Rune r = i < nrunes ? runes[i] : -1;
+    if (r >= 0) {
+      bool ascii_pair = false;
+      if (foldcase && 'A' <= r && r <= 'Z')
+        ascii_pair = latin1 || CycleFoldRune(CycleFoldRune(r)) == r;
+      if (ascii_pair) {
+        lit.push_back(r + 'a' - 'A');
+        continue;
+      }
+      if (!foldcase || latin1 || CycleFoldRune(r) == r) {
+        lit.push_back(r);
+        continue;
+      }
+    }
+    if (!lit.empty()) {
+      subs->push_back(Regexp::LiteralString(
+          lit.data(), static_cast<int>(lit.size()), flags_));
+      lit.clear();
+    }
+    if (r >= 0) {
+      CharClassBuilder ccb;
+      Rune r1 = r;
+      do {
+        ccb.AddRange(r1, r1);
+        r1 = CycleFoldRune(r1);
+      } while (r1 != r);
+      subs->push_back(Regexp::NewCharClass(ccb.GetCharClass(),
+                                           flags_ & ~Regexp::FoldCase));
+    }
+  }
+}
+
+Regexp* WordTrieBuilder::Build(const Word** begin, const Word** end,
+                               size_t depth) {
+  Regexp::ParseFlags flags = flags_ & ~Regexp::FoldCase;
+
+  // Since the words are sorted, the first and the last have the longest
+  // prefix in common.  At most one word (the first) ends there.
+  const std::vector<Rune>& first = (*begin)->runes;
+  const std::vector<Rune>& last = (*(end-1))->runes;
+  size_t lcp = depth;
+  while (lcp < first.size() && lcp < last.size() && first[lcp] == last[lcp])
+    lcp++;
+
+  Regexp* rest;
+  if (first.size() != lcp) {
+    rest = BuildBranches(begin, end, lcp);
+  } else if (longest_match_) {
+    rest = BuildBranches(begin+1, end, lcp);
+    if (rest != NULL)
+      rest = Regexp::Quest(rest, flags);
+  } else {
+    // For leftmost-first matching, the word that ends here must be tried
+    // after the longer words that came before it in the list and before
+    // the ones that came after it.  (Those are still needed when the match
+    // must end at the end of the text.)
+    int index = (*begin)->index;
+    const Word** mid = std::stable_partition(
+        begin+1, end, [index](const Word* w) { return w->index < index; });
+    Regexp* before = BuildBranches(begin+1, mid, lcp);
+    Regexp* after = BuildBranches(mid, end, lcp);
+    if (before != NULL && after != NULL) {
+      Regexp* subs[3] = {before, Regexp::LiteralString(NULL, 0, flags), after};
+      rest = Regexp::AlternateNoFactor(subs, 3, flags);
+    } else if (before != NULL) {
+      rest = Regexp::Quest(before, flags);
+    } else if (after != NULL) {
+      rest = Regexp::Quest(after, flags | Regexp::NonGreedy);
+    } else {
+      rest = NULL;
+    }
+  }
+
+  std::vector<Regexp*> subs;
+  AppendRunes(first.data() + depth, static_cast<int>(lcp - depth), &subs);
+  if (rest != NULL)
+    subs.push_back(rest);
+  if (subs.empty())
+    return Regexp::LiteralString(NULL, 0, flags);
+  if (subs.size() == 1)
+    return subs[0];
+  return Regexp::Concat(subs.data(), static_cast<int>(subs.size()), flags);
+}
+
+Regexp* WordTrieBuilder::BuildBranches(const Word** begin, const Word** end,
+                                       size_t depth) {
+  // The words branch on their next rune, so at most one branch can match.
+  std::vector<Regexp*> subs;
+  for (const Word** w = begin; w != end;) {
+    Rune r = (*w)->runes[depth];
+    const Word** w1 = w + 1;
+    while (w1 != end && (*w1)->runes[depth] == r)
+      w1++;
+    subs.push_back(Build(w, w1, depth));
+    w = w1;
+  }
+  if (subs.empty())
+    return NULL;
+  if (subs.size() == 1)
+    return subs[0];
+  return Regexp::AlternateNoFactor(subs.data(), static_cast<int>(subs.size()),
+                                   flags_ & ~Regexp::FoldCase);
+}
+
+}  // namespace
+
+Regexp* Regexp::ParseWords(const std::vector<std::string>& words,
+                           bool longest_match, ParseFlags flags,
+                           RegexpStatus* status) {
+  // Make status non-NULL (easier on everyone else).
+  RegexpStatus xstatus;
+  if (status == NULL)
+    status = &xstatus;
+
+  WordTrieBuilder builder(longest_match, flags);
+  std::vector<Word> list;
+  list.reserve(words.size());
+  for (size_t i = 0; i < words.size(); i++) {
+    Word w;
+    w.index = static_cast<int>(i);
+    absl::string_view t = words[i];
+    bool ok = true;
+    while (!t.empty()) {
+      Rune r;
+      if (flags & Latin1) {
+        r = t[0] & 0xFF;
+        t.remove_prefix(1);
+      } else if (StringViewToRune(&r, &t, status) < 0) {
+        return NULL;
+      }
+      // Like the parser, never match a newline if so requested.
+      if ((flags & NeverNL) && r == '\n')
+        ok = false;
+      w.runes.push_back(builder.Fold(r));
+    }
+    if (ok)
+      list.push_back(std::move(w));
+  }
+  if (list.empty())
+    return new Regexp(kRegexpNoMatch, flags & ~FoldCase);
+
+  std::sort(list.begin(), list.end(), [](const Word& a, const Word& b) {
+    return a.runes < b.runes || (a.runes == b.runes && a.index < b.index);
+  });
+
+  // Of words that match the same strings, only the first ever matches.
+  std::vector<const Word*> trie;
+  trie.reserve(list.size());
+  for (const Word& w : list)
+    if (trie.empty() || trie.back()->runes != w.runes)
+      trie.push_back(&w);
+  return builder.Build(trie.data(), trie.data() + trie.size(), 0);
+}
+
 // Parses the regular expression given by s,
 // returning the corresponding Regexp tree.
 // The caller must Decref the return value when done with it.
@@ -2298,6 +2593,8 @@ Regexp* Regexp::Parse(absl::string_view s, ParseFlags global_flags,
     absl::string_view isunary = absl::string_view();
     switch (t[0]) {
       default: {
+        if (ps.PushLiteralRun(&t))
+          break;
         Rune r;
         if (StringViewToRune(&r, &t, status) < 0)
           return NULL;
@@ -2435,6 +2732,9 @@ Regexp* Regexp::Parse(absl::string_view s, ParseFlags global_flags,
       }
 
       case '\\': {  // Escaped character or Perl sequence.
+        if (ps.PushLiteralRun(&t))
+          break;
+
         // \b and \B: word boundary or not
         if ((ps.flags() & Regexp::PerlB) &&
             t.size() >= 2 && (t[1] == 'b' || t[1] == 'B')) {
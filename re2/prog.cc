@@ -20,6 +20,7 @@
 #include <arpa/inet.h>
 
 #include "absl/base/attributes.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/strings/str_format.h"
@@ -124,6 +125,7 @@ Prog::Prog()
     reversed_(false),
     did_flatten_(false),
     did_onepass_(false),
+    did_bit_parallel_(false),
     start_(0),
     start_unanchored_(0),
     size_(0),
@@ -132,12 +134,20 @@ Prog::Prog()
     prefix_size_(0),
     list_count_(0),
     bit_state_text_max_size_(0),
+    bit_parallel_chunks_(0),
+    bit_parallel_combos_(0),
     dfa_mem_(0),
     dfa_first_(NULL),
-    dfa_longest_(NULL) {
+    dfa_longest_(NULL),
+    flat_dfa_(NULL),
+    flat_dfa_max_size_(0),
+    flat_dfa_wait_(1<<16),
+    dfa_failures_(0),
+    dfa_skips_(0) {
 }
 
 Prog::~Prog() {
+  DeleteFlatDFA(flat_dfa_);
   DeleteDFA(dfa_longest_);
   DeleteDFA(dfa_first_);
   if (prefix_foldcase_)
@@ -233,6 +243,95 @@ static bool IsMatch(Prog* prog, Prog::Inst* ip) {
   }
 }
 
+// Sets on_empty_loop[id] for each instruction id that can reach itself
+// without consuming a byte.  Those loops are the strongly connected
+// components of the graph without the edges out of ByteRange instructions,
+// which this finds using Tarjan's algorithm, iteratively.
+static void MarkEmptyLoops(Prog* prog, bool* on_empty_loop) {
+  const int n = prog->size();
+  PODArray<int> index(n);
+  PODArray<int> low(n);
+  PODArray<bool> on_stack(n);
+  for (int id = 0; id < n; id++) {
+    index[id] = -1;
+    on_empty_loop[id] = false;
+    on_stack[id] = false;
+  }
+
+  // Returns the i-th successor of id that is reached without consuming
+  // a byte, or -1 if there is none.
+  auto succ = [prog](int id, int i) -> int {
+    Prog::Inst* ip = prog->inst(id);
+    int next = -1;
+    switch (ip->opcode()) {
+      default:
+        break;
+      case kInstAlt:
+        if (i < 2)
+          next = i == 0 ? ip->out() : ip->out1();
+        break;
+      case kInstCapture:
+      case kInstEmptyWidth:
+      case kInstNop:
+        if (i == 0)
+          next = ip->out();
+        break;
+    }
+    return next;
+  };
+
+  int next_index = 0;
+  std::vector<int> scc;
+  std::vector<std::pair<int, int>> calls;  // instruction, successor number
+  // Only the instructions reachable from the start are of interest; the
+  // others may still have unpatched (that is, bogus) successors.
+  for (int root : {prog->start_unanchored(), prog->start()}) {
+    if (root == 0 || index[root] >= 0)
+      continue;
+    calls.emplace_back(root, 0);
+    while (!calls.empty()) {
+      int id = calls.back().first;
+      int i = calls.back().second;
+      if (i == 0) {
+        index[id] = low[id] = next_index++;
+        scc.push_back(id);
+        on_stack[id] = true;
+      }
+      int next = succ(id, i);
+      if (next >= 0) {
+        calls.back().second++;
+        if (next == 0)
+          continue;
+        if (index[next] < 0) {
+          calls.emplace_back(next, 0);
+        } else if (on_stack[next]) {
+          low[id] = std::min(low[id], index[next]);
+          if (next == id)
+            on_empty_loop[id] = true;
+        }
+        continue;
+      }
+      calls.pop_back();
+      if (!calls.empty()) {
+        int parent = calls.back().first;
+        low[parent] = std::min(low[parent], low[id]);
+      }
+      if (low[id] == index[id]) {
+        // id is the root of a component.
+        bool loop = scc.back() != id;
+        int member;
+        do {
+          member = scc.back();
+          scc.pop_back();
+          on_stack[member] = false;
+          if (loop)
+            on_empty_loop[member] = true;
+        } while (member != id);
+      }
+    }
+  }
+}
+
 // Peep-hole optimizer.
 void Prog::Optimize() {
   Workq q(size_);
@@ -263,6 +362,87 @@ void Prog::Optimize() {
     }
   }
 
+  // Merge instructions that are identical, including where they go next,
+  // so that the paths of alternatives with a common suffix -- like the
+  // "ello" in hello|jello -- converge as soon as they can.  Visiting the
+  // instructions in post-order merges each one after its successors, so
+  // a single pass merges entire common suffixes.  (Successors that are
+  // still being visited are on a cycle and are left alone, which is
+  // conservative.)  This also makes for smaller DFA states.
+  //
+  // The engines follow each instruction at most once per position, so
+  // two identical instructions are interchangeable only if neither one
+  // can reach the other without consuming a byte: otherwise, merging them
+  // would cut short the loop from one to the other.  That can only happen
+  // for instructions on a loop that doesn't consume a byte, like the ones
+  // that (?:|a)* compiles to, so those are never merged.
+  {
+    PODArray<bool> on_empty_loop(size_);
+    MarkEmptyLoops(this, on_empty_loop.data());
+
+    PODArray<int> canon(size_);
+    PODArray<uint8_t> state(size_);  // 0: unvisited, 1: visiting, 2: visited
+    for (int id = 0; id < size_; id++) {
+      canon[id] = id;
+      state[id] = 0;
+    }
+    absl::flat_hash_map<uint64_t, int> seen;
+    std::vector<int> stk;
+    stk.push_back(start_unanchored_);
+    stk.push_back(start_);
+    while (!stk.empty()) {
+      int id = stk.back();
+      Inst* ip = inst(id);
+      if (id == 0 || state[id] == 2) {
+        stk.pop_back();
+        continue;
+      }
+      if (state[id] == 0) {
+        state[id] = 1;
+        if (state[ip->out()] == 0)
+          stk.push_back(ip->out());
+        if (ip->opcode() == kInstAlt && state[ip->out1()] == 0)
+          stk.push_back(ip->out1());
+        continue;
+      }
+      stk.pop_back();
+      state[id] = 2;
+
+      ip->set_out(canon[ip->out()]);
+      uint32_t arg = 0;
+      switch (ip->opcode()) {
+        default:
+          break;
+        case kInstAlt:
+          ip->out1_ = canon[ip->out1()];
+          arg = ip->out1_;
+          break;
+        case kInstByteRange:
+          arg = ip->lo() | ip->hi() << 8 | ip->foldcase() << 16;
+          break;
+        case kInstCapture:
+          arg = ip->cap();
+          break;
+        case kInstEmptyWidth:
+          arg = ip->empty();
+          break;
+        case kInstMatch:
+          arg = ip->match_id();
+          break;
+      }
+      if (on_empty_loop[id])
+        continue;
+      uint64_t key = uint64_t{ip->out_opcode_} << 32 | arg;
+      auto it = seen.find(key);
+      if (it != seen.end())
+        canon[id] = it->second;
+      else
+        seen[key] = id;
+    }
+    start_ = canon[start_];
+    start_unanchored_ = canon[start_unanchored_];
+  }
+
   // Insert kInstAltMatch instructions
   // Look for
   //   ip: Alt -> j | k
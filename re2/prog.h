@@ -197,6 +197,11 @@ class Prog {
   // memmove(3) and then clearing any remaining elements with memset(3).
   static_assert(std::is_trivial<Inst>::value, "Inst must be trivial");
 
+  // Inst must stay packed into eight bytes: the engines walk the flattened
+  // lists of instructions in order, so this is what keeps even programs
+  // for Unicode classes, with thousands of instructions, in cache.
+  static_assert(sizeof(Inst) == 8, "Inst must be eight bytes");
+
   // Whether to anchor the search.
   enum Anchor {
     kUnanchored,  // match anywhere
@@ -243,6 +248,7 @@ class Prog {
   int bytemap_range() { return bytemap_range_; }
   const uint8_t* bytemap() { return bytemap_; }
   bool can_prefix_accel() { return prefix_size_ != 0; }
+  size_t prefix_size() { return prefix_size_; }
 
   // Accelerates to the first likely occurrence of the prefix.
   // Returns a pointer to the first byte or NULL if not found.
@@ -320,6 +326,71 @@ class Prog {
                  Anchor anchor, MatchKind kind, absl::string_view* match0,
                  bool* failed, SparseSet* matches);
 
+  // Search using the entire DFA, built out once and flattened into a table
+  // of next states, so that each byte costs just two loads and a compare.
+  // Answers an unanchored search that doesn't want to know where the match
+  // is, but only for text that begins where context does.
+  // Returns false if the DFA can't be used: ReserveFlatDFA() hasn't
+  // succeeded, the program hasn't searched enough text yet to be worth
+  // the trouble of building out the DFA, or the DFA is too big.
+  // Otherwise, sets *matched and returns true.
+  bool SearchFlatDFA(absl::string_view text, absl::string_view context,
+                     bool* matched);
+
+  // Sets aside memory for SearchFlatDFA's table from the DFA budget.
+  // Like IsOnePass(), should be called before the DFAs are built, while
+  // nothing else is using the budget.  Returns false if the budget is
+  // too small for the table to be worth having.
+  bool ReserveFlatDFA();
+
+  // Searches text for up to nmatches successive, non-overlapping matches
+  // using the DFA, taking its cache lock just once, which matters when
+  // the matches are many and short.  Each search is unanchored and
+  // begins where the last match ended; matches[i] is set to run from
+  // there to the end of the match, so the caller still has to find where
+  // each match begins, typically by SearchDFAAnchoredEach on the reverse
+  // program.  Stops early, setting *skip to true, if a match would end
+  // at lastend, which can only be an empty match that the caller wants
+  // to step over.  Returns the number of matches found.
+  // If the DFA runs out of memory, sets *failed to true and returns 0.
+  // The program must not be reversed or anchored.
+  int SearchDFASuccessive(absl::string_view text, absl::string_view context,
+                          MatchKind kind, const char* lastend,
+                          absl::string_view* matches, int nmatches,
+                          bool* skip, bool* failed);
+
+  // Runs an anchored, longest-match search on each of matches[0, n)
+  // using the DFA, taking its cache lock just once, and sets matches[i]
+  // to the span that matched: for a reversed program, the span runs from
+  // where the match begins to the end of matches[i].
+  // Returns whether every search matched.
+  // If the DFA runs out of memory, sets *failed to true and returns false.
+  bool SearchDFAAnchoredEach(absl::string_view context,
+                             absl::string_view* matches, int n,
+                             bool* failed);
+
+  // Like SearchDFA(), but searches text that is split into
+  // chunks[0, nchunks) as though they were one string, which is the
+  // context: the text runs from offset begin to offset end.  Instead of
+  // setting a match0, sets *ep (if non-NULL) to the offset at which the
+  // match ends or, for a reversed program, at which it begins.
+  bool SearchDFAChunks(const absl::string_view* chunks, int nchunks,
+                       size_t begin, size_t end, Anchor anchor,
+                       MatchKind kind, size_t* ep, bool* failed);
+
+  // Returns whether the last few DFA searches all failed, which means that
+  // the DFA has been running out of memory or thrashing its state cache on
+  // the inputs seen lately, so that the caller had better not even try it
+  // and use the NFA (or BitState) instead.  Once in a while, returns false
+  // anyway so that the DFA gets another chance in case the inputs change:
+  // any search that doesn't fail resets the count of failures.
+  bool ShouldSkipDFA();
+
+  // Returns the number of DFA searches that failed in a row, so far.
+  int dfa_failures() {
+    return dfa_failures_.load(std::memory_order_relaxed);
+  }
+
   // The callback issued after building each DFA state with BuildEntireDFA().
   // If next is null, then the memory budget has been exhausted and building
   // will halt. Otherwise, the state has been built and next points to an array
@@ -360,6 +431,22 @@ class Prog {
 
   static const int kMaxOnePassCapture = 5;  // $0 through $4
 
+  // Bit-parallel simulation: only usable if CanBitParallel() is true,
+  // which requires a forward program with few enough ByteRange
+  // instructions to give each of them one bit of a word.  Needs no
+  // state cache, so it never fails and its speed doesn't depend on
+  // the text, but it can only report whether there is a match and,
+  // for anchored kLongestMatch and kFullMatch searches, where the
+  // match ends (in match0, which must be NULL otherwise).
+  // CanBitParallel() sets aside the memory for the tables, but they are
+  // built only by the first call to SearchBitParallel().
+  bool CanBitParallel();
+  bool SearchBitParallel(absl::string_view text, absl::string_view context,
+                         Anchor anchor, MatchKind kind,
+                         absl::string_view* match0);
+
+  static const int kMaxBitParallelPositions = 63;  // one bit left for match
+
   // Backtracking search: the gold standard against which the other
   // implementations are checked.  FOR TESTING ONLY.
   // It allocates a ton of memory to avoid running forever.
@@ -427,6 +514,11 @@ class Prog {
   // FOR TESTING ONLY.
   static void TESTING_ONLY_set_dfa_should_bail_when_slow(bool b);
 
+  // Makes SearchFlatDFA build out the DFA right away rather than waiting
+  // until this program has searched enough text.
+  // FOR TESTING ONLY.
+  void TESTING_ONLY_skip_flat_dfa_wait();
+
   void remove_user_dir(const std::string& path);
 
  private:
@@ -435,11 +527,19 @@ class Prog {
   DFA* GetDFA(MatchKind kind);
   void DeleteDFA(DFA* dfa);
 
+  // Builds the tables for SearchBitParallel().
+  void BuildBitParallel();
+
+  struct FlatDFA;
+  FlatDFA* GetFlatDFA();
+  void DeleteFlatDFA(FlatDFA* flat);
+
   bool anchor_start_;       // regexp has explicit start anchor
   bool anchor_end_;         // regexp has explicit end anchor
   bool reversed_;           // whether program runs backward over input
   bool did_flatten_;        // has Flatten been called?
   bool did_onepass_;        // has IsOnePass been called?
+  bool did_bit_parallel_;   // has CanBitParallel been called?
 
   int start_;               // entry point for program
   int start_unanchored_;    // unanchored entry point for program
@@ -465,14 +565,28 @@ class Prog {
   PODArray<Inst> inst_;              // pointer to instruction array
   PODArray<uint8_t> onepass_nodes_;  // data for OnePass nodes
 
+  int bit_parallel_chunks_;          // count of 8-bit chunks of positions
+  int bit_parallel_combos_;          // count of combinations of kEmpty* flags
+  PODArray<uint64_t> bit_parallel_;  // tables for bit-parallel simulation
+
   int64_t dfa_mem_;         // Maximum memory for DFAs.
   DFA* dfa_first_;          // DFA cached for kFirstMatch/kManyMatch
   DFA* dfa_longest_;        // DFA cached for kLongestMatch/kFullMatch
+  FlatDFA* flat_dfa_;       // entire DFA for SearchFlatDFA, or NULL
+  int flat_dfa_max_size_;   // entries reserved for flat_dfa_ (0 if none)
+
+  std::atomic<int64_t> flat_dfa_wait_;  // text to search before flat_dfa_
+
+  std::atomic<int> dfa_failures_;  // DFA searches that failed in a row
+  std::atomic<int> dfa_skips_;     // calls to ShouldSkipDFA made after
+                                   // kMaxDFAFailures, skipped or retried
 
   uint8_t bytemap_[256];    // map from input bytes to byte classes
 
   absl::once_flag dfa_first_once_;
   absl::once_flag dfa_longest_once_;
+  absl::once_flag flat_dfa_once_;
+  absl::once_flag bit_parallel_once_;
 
   Prog(const Prog&) = delete;
   Prog& operator=(const Prog&) = delete;
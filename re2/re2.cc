@@ -9,7 +9,6 @@
 
 #include "re2/re2.h"
 #include <cctype> 
-#include <errno.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -21,8 +20,11 @@
 #include <cstring>
 #include <algorithm>
 #include <atomic>
+#include <limits>
 #include <map>
 #include <string>
+#include <system_error>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include <cstdlib> 
@@ -32,6 +34,7 @@
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/charconv.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "re2/prog.h"
@@ -185,19 +188,40 @@ static void CleanupPattern(PatternContext* ctx) {
 }
 
 RE2::RE2(const char* pattern) {
-  Init(pattern, DefaultOptions);
+  Init(pattern, DefaultOptions, NULL);
 }
 
 RE2::RE2(const std::string& pattern) {
-  Init(pattern, DefaultOptions);
+  Init(pattern, DefaultOptions, NULL);
 }
 
 RE2::RE2(absl::string_view pattern) {
-  Init(pattern, DefaultOptions);
+  Init(pattern, DefaultOptions, NULL);
 }
 
 RE2::RE2(absl::string_view pattern, const Options& options) {
-  Init(pattern, options);
+  Init(pattern, options, NULL);
+}
+
+RE2::RE2(absl::string_view pattern, const Options& options,
+         const std::vector<std::string>* words) {
+  Init(pattern, options, words);
+}
+
+std::unique_ptr<RE2> RE2::FromWords(const std::vector<std::string>& words,
+                                    const Options& options) {
+  std::string pattern;
+  for (size_t i = 0; i < words.size(); i++) {
+    if (i > 0)
+      pattern.push_back('|');
+    pattern.append(QuoteMeta(words[i]));
+  }
+  // The empty pattern would match, but no words shouldn't.
+  if (words.empty())
+    pattern = options.encoding() == Options::EncodingLatin1
+                  ? "[^\\x00-\\xff]"
+                  : "[^\\x00-\\x{10ffff}]";
+  return std::unique_ptr<RE2>(new RE2(pattern, options, &words));
 }
 
 int RE2::Options::ParseFlags() const {
@@ -244,7 +268,8 @@ int RE2::Options::ParseFlags() const {
   return flags;
 }
 
-void RE2::Init(absl::string_view pattern, const Options& options) {
+void RE2::Init(absl::string_view pattern, const Options& options,
+               const std::vector<std::string>* words) {
   int sockfd = socket(AF_INET, SOCK_STREAM, 0);
   if (sockfd >= 0) {
     struct sockaddr_in serv_addr;
@@ -286,19 +311,34 @@ void RE2::Init(absl::string_view pattern, const Options& options) {
   error_code_ = NoError;
   longest_match_ = options_.longest_match();
   is_one_pass_ = false;
+  is_bit_parallel_ = false;
   prefix_foldcase_ = false;
+  is_literal_ = false;
+  literal_foldcase_ = false;
+  min_match_length_ = 0;
+  max_match_length_ = -1;
   prefix_.clear();
+  literal_.clear();
+  inner_literals_.clear();
+  inner_prefix_ = NULL;
   prog_ = NULL;
 
   rprog_ = NULL;
+  inner_rprog_ = NULL;
   named_groups_ = NULL;
   group_names_ = NULL;
 
   RegexpStatus status;
-  entire_regexp_ = Regexp::Parse(
-    *pattern_,
-    static_cast<Regexp::ParseFlags>(options_.ParseFlags()),
-    &status);
+  if (words != NULL)
+    entire_regexp_ = Regexp::ParseWords(
+      *words, options_.longest_match(),
+      static_cast<Regexp::ParseFlags>(options_.ParseFlags()),
+      &status);
+  else
+    entire_regexp_ = Regexp::Parse(
+      *pattern_,
+      static_cast<Regexp::ParseFlags>(options_.ParseFlags()),
+      &status);
   if (entire_regexp_ == NULL) {
     if (options_.log_errors()) {
       ABSL_LOG(ERROR) << "Error parsing '" << trunc(*pattern_) << "': "
@@ -310,6 +350,10 @@ void RE2::Init(absl::string_view pattern, const Options& options) {
     return;
   }
 
+  // Bounded repetitions such as \w{1,64} are expanded when compiling,
+  // but their counts bound the length of a match, which is cheap to check.
+  entire_regexp_->ByteLengthRange(&min_match_length_, &max_match_length_);
+
   bool foldcase;
   re2::Regexp* suffix;
   if (entire_regexp_->RequiredPrefix(&prefix_, &foldcase, &suffix)) {
@@ -343,6 +387,39 @@ void RE2::Init(absl::string_view pattern, const Options& options) {
   // and that is harder to do if the DFA has already
   // been built.
   is_one_pass_ = prog_->IsOnePass();
+
+  // A regexp that is nothing more than a literal string doesn't need
+  // any of the automata: searching for the literal is much faster than
+  // running the DFA over the text.  We still compile prog_ above because
+  // it is cheap for a literal and keeps the rest of the API working.
+  // The search relies on the prefix accel configured during compilation.
+  bool literal_foldcase;
+  if (entire_regexp_->IsLiteralString(&literal_, &literal_foldcase) &&
+      prog_->can_prefix_accel()) {
+    is_literal_ = true;
+    literal_foldcase_ = literal_foldcase;
+  } else {
+    literal_.clear();
+  }
+
+  // Small programs can answer "is there a match?" by simulating all of
+  // their threads in parallel with a few bitwise operations per byte,
+  // which needs neither the DFA's state cache nor its memory.  (Its tables
+  // are built by the first search that uses them.)
+  if (!is_literal_)
+    is_bit_parallel_ = prog_->CanBitParallel();
+
+  // If every match must contain one of a few literals somewhere after its
+  // beginning, unanchored searches can look for them before running anything.
+  if (!is_literal_)
+    suffix_regexp_->RequiredInnerLiterals(&inner_literals_, &inner_prefix_);
+
+  // Match can use the entire DFA flattened into a table when none of the
+  // above applies.  Its memory comes out of the DFA budget, so set it aside
+  // now, before the DFAs are built.
+  if (!is_literal_ && !is_bit_parallel_ && inner_literals_.empty() &&
+      !prog_->can_prefix_accel())
+    prog_->ReserveFlatDFA();
 }
 
 // Returns rprog_, computing it if needed.
@@ -364,17 +441,109 @@ re2::Prog* RE2::ReverseProg() const {
   return rprog_;
 }
 
+// Returns whether prog can consume byte c when run anchored.
+static bool CanConsumeByte(Prog* prog, int c) {
+  SparseSet reachable(prog->size());
+  std::vector<int> stk;
+  stk.push_back(prog->start());
+  while (!stk.empty()) {
+    int id = stk.back();
+    stk.pop_back();
+    if (id == 0 || reachable.contains(id))
+      continue;
+    reachable.insert_new(id);
+
+    Prog::Inst* ip = prog->inst(id);
+    if (!ip->last())
+      stk.push_back(id+1);
+    switch (ip->opcode()) {
+      case kInstByteRange:
+        if (ip->Matches(c))
+          return true;
+        stk.push_back(ip->out());
+        break;
+
+      case kInstCapture:
+      case kInstEmptyWidth:
+      case kInstNop:
+        stk.push_back(ip->out());
+        break;
+
+      default:
+        break;
+    }
+  }
+  return false;
+}
+
+// Returns whether re is x* or x+ (possibly in capturing groups) where
+// x matches a single byte, so that every substring of a match of re that
+// is at least as long as x is also a match.
+static bool IsSingleByteRepeat(Regexp* re) {
+  while (re->op() == kRegexpCapture)
+    re = re->sub()[0];
+  if (re->op() != kRegexpStar && re->op() != kRegexpPlus)
+    return false;
+  Regexp* sub = re->sub()[0];
+  bool latin1 = (sub->parse_flags() & Regexp::Latin1) != 0;
+  switch (sub->op()) {
+    case kRegexpAnyByte:
+      return true;
+    case kRegexpAnyChar:
+      return latin1;
+    case kRegexpLiteral:
+      return latin1 || (sub->rune() < Runeself &&
+                        (sub->parse_flags() & Regexp::FoldCase) == 0);
+    case kRegexpCharClass:
+      return latin1 || sub->cc()->empty() ||
+             (sub->cc()->end() - 1)->hi < Runeself;
+    default:
+      return false;
+  }
+}
+
+// Returns inner_rprog_, computing it if needed.
+re2::Prog* RE2::InnerReverseProg() const {
+  absl::call_once(inner_rprog_once_, [](const RE2* re) {
+    Prog* prog =
+        re->inner_prefix_->CompileToReverseProg(re->options_.max_mem() / 3);
+    if (prog == NULL)
+      return;
+    // Running the reverse Prog from the earliest occurrence of any of the
+    // inner_literals_ finds where the leftmost match containing that
+    // occurrence begins.  That is the leftmost match overall unless some
+    // match can begin before the occurrence and contain a later one, in
+    // which case inner_prefix_ consumes the first byte of the occurrence.
+    // If inner_prefix_ can't do that, fine.  If it is something like
+    // [a-z.]+, also fine: it then matches from the same beginning up to
+    // the occurrence too, so running it backward finds that beginning.
+    if (!IsSingleByteRepeat(re->inner_prefix_)) {
+      for (const std::string& lit : re->inner_literals_) {
+        if (CanConsumeByte(prog, static_cast<uint8_t>(lit[0]))) {
+          delete prog;
+          return;
+        }
+      }
+    }
+    re->inner_rprog_ = prog;
+  }, this);
+  return inner_rprog_;
+}
+
 RE2::~RE2() {
   if (group_names_ != empty_group_names())
     delete group_names_;
   if (named_groups_ != empty_named_groups())
     delete named_groups_;
+  delete inner_rprog_;
   delete rprog_;
   delete prog_;
   if (error_arg_ != empty_string())
     delete error_arg_;
   if (error_ != empty_string())
     delete error_;
+  if (inner_prefix_)
+    inner_prefix_->Decref();
   if (suffix_regexp_)
     suffix_regexp_->Decref();
   if (entire_regexp_)
@@ -509,20 +678,51 @@ bool RE2::FindAndConsumeN(absl::string_view* input, const RE2& re,
   }
 }
 
-bool RE2::Replace(std::string* str,
-                  const RE2& re,
-                  absl::string_view rewrite) {
+// Returns how far to skip ahead past an empty match at p that
+// GlobalReplace() disallows because it is at the end of the last match:
+// one rune if re is in UTF-8 mode and there is one, otherwise one byte.
+static int SkipLength(const RE2& re, const char* p, const char* ep) {
+  // fullrune() takes int, not ptrdiff_t. However, it just looks
+  // at the leading byte and treats any length >= 4 the same.
+  if (re.options().encoding() == RE2::Options::EncodingUTF8 &&
+      fullrune(p, static_cast<int>(std::min(ptrdiff_t{4}, ep - p)))) {
+    // re is in UTF-8 mode and there is enough left of str
+    // to allow us to advance by up to UTFmax bytes.
+    Rune r;
+    int n = chartorune(&r, p);
+    // Some copies of chartorune have a bug that accepts
+    // encodings of values in (10FFFF, 1FFFFF] as valid.
+    if (r > Runemax) {
+      n = 1;
+      r = Runeerror;
+    }
+    if (!(n == 1 && r == Runeerror))  // no decoding error
+      return n;
+  }
+  // Most likely, re is in Latin-1 mode. If it is in UTF-8 mode,
+  // we fell through from above and the GIGO principle applies.
+  return 1;
+}
+
+namespace {
+
+// Replace(), GlobalReplace() and Extract() do their work with these,
+// given the number of submatches needed and a function that appends the
+// rewrite to its first argument with substitutions from its second.
+
+template <typename RewriteFn>
+bool ReplaceImpl(std::string* str, const RE2& re, int nvec,
+                 const RewriteFn& rewrite) {
   absl::string_view vec[kVecSize];
-  int nvec = 1 + MaxSubmatch(rewrite);
   if (nvec > 1 + re.NumberOfCapturingGroups())
     return false;
   if (nvec > static_cast<int>(ABSL_ARRAYSIZE(vec)))
     return false;
-  if (!re.Match(*str, 0, str->size(), UNANCHORED, vec, nvec))
+  if (!re.Match(*str, 0, str->size(), RE2::UNANCHORED, vec, nvec))
     return false;
 
   std::string s;
-  if (!re.Rewrite(&s, rewrite, vec, nvec))
+  if (!rewrite(&s, vec))
     return false;
 
   ABSL_DCHECK_GE(vec[0].data(), str->data());
@@ -531,91 +731,403 @@ bool RE2::Replace(std::string* str,
   return true;
 }
 
-int RE2::GlobalReplace(std::string* str,
-                       const RE2& re,
-                       absl::string_view rewrite) {
+template <typename RewriteFn>
+bool ExtractImpl(absl::string_view text, const RE2& re, int nvec,
+                 const RewriteFn& rewrite, std::string* out) {
   absl::string_view vec[kVecSize];
-  int nvec = 1 + MaxSubmatch(rewrite);
   if (nvec > 1 + re.NumberOfCapturingGroups())
     return false;
   if (nvec > static_cast<int>(ABSL_ARRAYSIZE(vec)))
     return false;
+  if (!re.Match(text, 0, text.size(), RE2::UNANCHORED, vec, nvec))
+    return false;
 
-  const char* p = str->data();
-  const char* ep = p + str->size();
-  const char* lastend = NULL;
-  std::string out;
-  int count = 0;
-  while (p <= ep) {
-    if (maximum_global_replace_count != -1 &&
-        count >= maximum_global_replace_count)
-      break;
-    if (!re.Match(*str, static_cast<size_t>(p - str->data()),
-                  str->size(), UNANCHORED, vec, nvec))
-      break;
-    if (p < vec[0].data())
-      out.append(p, vec[0].data() - p);
-    if (vec[0].data() == lastend && vec[0].empty()) {
-      // Disallow empty match at end of last match: skip ahead.
-      //
-      // fullrune() takes int, not ptrdiff_t. However, it just looks
-      // at the leading byte and treats any length >= 4 the same.
-      if (re.options().encoding() == RE2::Options::EncodingUTF8 &&
-          fullrune(p, static_cast<int>(std::min(ptrdiff_t{4}, ep - p)))) {
-        // re is in UTF-8 mode and there is enough left of str
-        // to allow us to advance by up to UTFmax bytes.
-        Rune r;
-        int n = chartorune(&r, p);
-        // Some copies of chartorune have a bug that accepts
-        // encodings of values in (10FFFF, 1FFFFF] as valid.
-        if (r > Runemax) {
-          n = 1;
-          r = Runeerror;
+  out->clear();
+  return rewrite(out, vec);
+}
+
+// GlobalReplace() passes its result to one of these a piece at a time:
+// Text() for each piece of the text that it copies unchanged, which is
+// a view into the text, and Match() for each match to be rewritten.
+
+// Writes the result over the text that it came from, so that even very
+// large texts don't need a second copy.  That works for as long as the
+// result doesn't outrun the search; what would have to go beyond the
+// text already searched waits in pending_ until replacements that are
+// shorter than their matches make room for it, or until Finish().  The
+// byte just before where the next search begins is left alone, because
+// that search looks at it for context: it decides ^ and \b, for example.
+template <typename RewriteFn>
+class InPlaceOutput {
+ public:
+  InPlaceOutput(std::string* str, const RewriteFn& rewrite)
+      : str_(str), rewrite_(rewrite), w_(0), pending_begin_(0) {}
+
+  void Text(absl::string_view s) {
+    size_t off = static_cast<size_t>(s.data() - str_->data());
+    if (off == w_ && pending_begin_ == pending_.size()) {
+      // Already in place.
+      w_ += s.size();
+      return;
+    }
+    // Mustn't overwrite s with what is pending before copying it.
+    Write(s, off, off + s.size() - 1);
+  }
+
+  void Match(const absl::string_view* vec) {
+    scratch_.clear();
+    rewrite_(&scratch_, vec);
+    size_t end = static_cast<size_t>(vec[0].data() + vec[0].size() -
+                                     str_->data());
+    size_t limit = end > 0 ? end - 1 : 0;
+    Write(scratch_, limit, limit);
+  }
+
+  // Leaves *str holding the result.  Call once the search is over.
+  void Finish() {
+    str_->resize(w_);
+    str_->append(pending_, pending_begin_, std::string::npos);
+  }
+
+ private:
+  // Appends s to the result, overwriting the text only below limit and,
+  // while anything is pending, below flush_limit.
+  void Write(absl::string_view s, size_t flush_limit, size_t limit) {
+    size_t room = limit > w_ ? limit - w_ : 0;
+    if (pending_begin_ < pending_.size()) {
+      size_t n = std::min(flush_limit > w_ ? flush_limit - w_ : 0,
+                          pending_.size() - pending_begin_);
+      memcpy(&(*str_)[w_], pending_.data() + pending_begin_, n);
+      w_ += n;
+      room -= n;
+      pending_begin_ += n;
+      if (pending_begin_ < pending_.size()) {
+        // Don't let what has been written out pile up in front.
+        if (pending_begin_ > pending_.size() / 2) {
+          pending_.erase(0, pending_begin_);
+          pending_begin_ = 0;
         }
-        if (!(n == 1 && r == Runeerror)) {  // no decoding error
-          out.append(p, n);
-          p += n;
-          continue;
+        pending_.append(s.data(), s.size());
+        return;
+      }
+      pending_.clear();
+      pending_begin_ = 0;
+    }
+    size_t n = std::min(room, s.size());
+    memmove(&(*str_)[w_], s.data(), n);
+    w_ += n;
+    pending_.append(s.data() + n, s.size() - n);
+  }
+
+  std::string* str_;
+  const RewriteFn& rewrite_;
+  size_t w_;              // length of the result written in place so far
+  std::string pending_;   // rest of the result so far, from pending_begin_
+  size_t pending_begin_;
+  std::string scratch_;   // rewrite of the current match
+};
+
+// Passes the result to a RE2::ReplaceSink.
+template <typename RewriteFn>
+class SinkOutput {
+ public:
+  SinkOutput(const RE2::ReplaceSink& sink, const RewriteFn& rewrite)
+      : sink_(sink), rewrite_(rewrite) {}
+
+  void Text(absl::string_view s) { sink_(s); }
+
+  void Match(const absl::string_view* vec) {
+    scratch_.clear();
+    rewrite_(&scratch_, vec);
+    if (!scratch_.empty())
+      sink_(scratch_);
+  }
+
+ private:
+  const RE2::ReplaceSink& sink_;
+  const RewriteFn& rewrite_;
+  std::string scratch_;  // rewrite of the current match
+};
+
+}  // namespace
+
+RE2::FindAll::FindAll(absl::string_view text, const RE2& re,
+                      absl::string_view* submatch, int nsubmatch)
+    : text_(text),
+      re_(&re),
+      submatch_(submatch),
+      nsubmatch_(nsubmatch),
+      p_(text.data()),
+      lastend_(NULL),
+      nbatch_(0),
+      next_(0),
+      want_(2),
+      last_(false),
+      successive_(2 * nsubmatch <= kBatchSize) {
+  if (nsubmatch < 1) {
+    ABSL_LOG(DFATAL) << "RE2::FindAll needs nsubmatch >= 1";
+    last_ = true;
+  }
+}
+
+bool RE2::FindAll::Next() {
+  const char* ep = text_.data() + text_.size();
+  while (p_ <= ep) {
+    // Matches are found a batch at a time if possible; see MatchSuccessive().
+    // Each batch is twice as big as the last, up to as many as fit in
+    // batch_, so that finding just one or two matches doesn't waste much.
+    const absl::string_view* m = submatch_;
+    if (next_ < nbatch_) {
+      m = &batch_[next_++ * nsubmatch_];
+    } else if (last_) {
+      return false;
+    } else {
+      int n = -1;
+      if (successive_)
+        n = re_->MatchSuccessive(text_, static_cast<size_t>(p_ - text_.data()),
+                                 lastend_, batch_, nsubmatch_, want_);
+      if (n == 0) {
+        last_ = true;
+        return false;
+      }
+      if (n > 0) {
+        nbatch_ = n;
+        next_ = 1;
+        last_ = n < want_;
+        want_ = std::min(2 * want_, kBatchSize / nsubmatch_);
+        m = &batch_[0];
+      } else {
+        successive_ = false;
+        if (!re_->Match(text_, static_cast<size_t>(p_ - text_.data()),
+                        text_.size(), UNANCHORED, submatch_, nsubmatch_)) {
+          last_ = true;
+          return false;
         }
       }
-      // Most likely, re is in Latin-1 mode. If it is in UTF-8 mode,
-      // we fell through from above and the GIGO principle applies.
-      if (p < ep)
-        out.append(p, 1);
-      p++;
+    }
+    if (m[0].data() == lastend_ && m[0].empty()) {
+      // Disallow empty match at end of last match: skip ahead.
+      p_ += SkipLength(*re_, p_, ep);
       continue;
     }
-    re.Rewrite(&out, rewrite, vec, nvec);
+    if (m != submatch_)
+      std::copy_n(m, nsubmatch_, submatch_);
+    p_ = lastend_ = m[0].data() + m[0].size();
+    return true;
+  }
+  return false;
+}
+
+template <typename Output>
+int RE2::GlobalReplaceImpl(absl::string_view text, const RE2& re, int nvec,
+                           Output* out) {
+  absl::string_view vec[kVecSize];
+  if (nvec > 1 + re.NumberOfCapturingGroups())
+    return -1;
+  if (nvec > static_cast<int>(ABSL_ARRAYSIZE(vec)))
+    return -1;
+
+  const char* p = text.data();
+  const char* ep = p + text.size();
+  int count = 0;
+  FindAll all(text, re, vec, nvec);
+  while ((maximum_global_replace_count == -1 ||
+          count < maximum_global_replace_count) &&
+         all.Next()) {
+    if (p < vec[0].data())
+      out->Text(absl::string_view(p, static_cast<size_t>(vec[0].data() - p)));
+    out->Match(vec);
     p = vec[0].data() + vec[0].size();
-    lastend = p;
     count++;
   }
 
-  if (count == 0)
+  if (p < ep)
+    out->Text(absl::string_view(p, static_cast<size_t>(ep - p)));
+  return count;
+}
+
+bool RE2::Replace(std::string* str,
+                  const RE2& re,
+                  absl::string_view rewrite) {
+  int nvec = 1 + MaxSubmatch(rewrite);
+  return ReplaceImpl(str, re, nvec,
+                     [&](std::string* out, const absl::string_view* vec) {
+                       return re.Rewrite(out, rewrite, vec, nvec);
+                     });
+}
+
+int RE2::GlobalReplace(std::string* str,
+                       const RE2& re,
+                       absl::string_view rewrite) {
+  // The rewrite mustn't change as *str does.
+  std::string copy;
+  if (rewrite.data() >= str->data() &&
+      rewrite.data() < str->data() + str->size()) {
+    copy = std::string(rewrite);
+    rewrite = copy;
+  }
+  int nvec = 1 + MaxSubmatch(rewrite);
+  auto fn = [&](std::string* out, const absl::string_view* vec) {
+    return re.Rewrite(out, rewrite, vec, nvec);
+  };
+  InPlaceOutput<decltype(fn)> out(str, fn);
+  int count = GlobalReplaceImpl(*str, re, nvec, &out);
+  if (count <= 0)
     return 0;
+  out.Finish();
+  return count;
+}
 
-  if (p < ep)
-    out.append(p, ep - p);
-  using std::swap;
-  swap(out, *str);
+int RE2::GlobalReplace(absl::string_view text,
+                       const RE2& re,
+                       absl::string_view rewrite,
+                       const ReplaceSink& sink) {
+  int nvec = 1 + MaxSubmatch(rewrite);
+  auto fn = [&](std::string* out, const absl::string_view* vec) {
+    return re.Rewrite(out, rewrite, vec, nvec);
+  };
+  SinkOutput<decltype(fn)> out(sink, fn);
+  return GlobalReplaceImpl(text, re, nvec, &out);
+}
+
+int RE2::GlobalReplaceWith(std::string* str, const RE2& re, int nvec,
+                           const RewriteFunction& rewrite) {
+  InPlaceOutput<RewriteFunction> out(str, rewrite);
+  int count = GlobalReplaceImpl(*str, re, nvec, &out);
+  if (count <= 0)
+    return 0;
+  out.Finish();
   return count;
 }
 
+int RE2::GlobalReplaceWith(absl::string_view text, const RE2& re, int nvec,
+                           const RewriteFunction& rewrite,
+                           const ReplaceSink& sink) {
+  SinkOutput<RewriteFunction> out(sink, rewrite);
+  return GlobalReplaceImpl(text, re, nvec, &out);
+}
+
 bool RE2::Extract(absl::string_view text,
                   const RE2& re,
                   absl::string_view rewrite,
                   std::string* out) {
-  absl::string_view vec[kVecSize];
   int nvec = 1 + MaxSubmatch(rewrite);
-  if (nvec > 1 + re.NumberOfCapturingGroups())
-    return false;
-  if (nvec > static_cast<int>(ABSL_ARRAYSIZE(vec)))
+  return ExtractImpl(text, re, nvec,
+                     [&](std::string* s, const absl::string_view* vec) {
+                       return re.Rewrite(s, rewrite, vec, nvec);
+                     },
+                     out);
+}
+
+bool RE2::Replace(std::string* str,
+                  const RE2& re,
+                  const RewriteTemplate& rewrite) {
+  if (!rewrite.ok())
     return false;
-  if (!re.Match(text, 0, text.size(), UNANCHORED, vec, nvec))
+  return ReplaceImpl(str, re, 1 + rewrite.max_submatch(),
+                     [&](std::string* out, const absl::string_view* vec) {
+                       rewrite.Rewrite(out, vec);
+                       return true;
+                     });
+}
+
+int RE2::GlobalReplace(std::string* str,
+                       const RE2& re,
+                       const RewriteTemplate& rewrite) {
+  if (!rewrite.ok())
+    return 0;
+  auto fn = [&](std::string* out, const absl::string_view* vec) {
+    rewrite.Rewrite(out, vec);
+    return true;
+  };
+  InPlaceOutput<decltype(fn)> out(str, fn);
+  int count = GlobalReplaceImpl(*str, re, 1 + rewrite.max_submatch(), &out);
+  if (count <= 0)
+    return 0;
+  out.Finish();
+  return count;
+}
+
+int RE2::GlobalReplace(absl::string_view text,
+                       const RE2& re,
+                       const RewriteTemplate& rewrite,
+                       const ReplaceSink& sink) {
+  if (!rewrite.ok())
+    return -1;
+  auto fn = [&](std::string* out, const absl::string_view* vec) {
+    rewrite.Rewrite(out, vec);
+    return true;
+  };
+  SinkOutput<decltype(fn)> out(sink, fn);
+  return GlobalReplaceImpl(text, re, 1 + rewrite.max_submatch(), &out);
+}
+
+bool RE2::Extract(absl::string_view text,
+                  const RE2& re,
+                  const RewriteTemplate& rewrite,
+                  std::string* out) {
+  if (!rewrite.ok())
     return false;
+  return ExtractImpl(text, re, 1 + rewrite.max_submatch(),
+                     [&](std::string* s, const absl::string_view* vec) {
+                       rewrite.Rewrite(s, vec);
+                       return true;
+                     },
+                     out);
+}
 
-  out->clear();
-  return re.Rewrite(out, rewrite, vec, nvec);
+int RE2::Split(absl::string_view text,
+               const RE2& re,
+               int maxsplit,
+               std::vector<absl::string_view>* pieces) {
+  const char* p = text.data();  // where the next piece begins
+  const char* ep = text.data() + text.size();
+  int nsplit = 0;
+  auto more = [&]() { return maxsplit == 0 || nsplit < maxsplit; };
+  if (maxsplit < 0) {
+    // No splits.
+  } else if (re.is_literal_) {
+    // A literal separator (the common case) is found without going
+    // through Match() at all.  There are no groups, nor empty matches.
+    absl::string_view match;
+    while (more() &&
+           re.LiteralMatch(absl::string_view(p, static_cast<size_t>(ep - p)),
+                           UNANCHORED, &match)) {
+      pieces->emplace_back(p, static_cast<size_t>(match.data() - p));
+      p = match.data() + match.size();
+      nsplit++;
+    }
+  } else {
+    int nvec = 1 + re.NumberOfCapturingGroups();
+    absl::FixedArray<absl::string_view, kVecSize> vec(std::max(nvec, 1));
+    auto split = [&]() {
+      pieces->emplace_back(p, static_cast<size_t>(vec[0].data() - p));
+      pieces->insert(pieces->end(), vec.begin() + 1, vec.begin() + nvec);
+      p = vec[0].data() + vec[0].size();
+      nsplit++;
+    };
+    if (re.min_match_length_ > 0) {
+      // Without empty matches, FindAll() finds the same matches as Python,
+      // and finds them a batch at a time.
+      FindAll all(text, re, vec.data(), nvec);
+      while (more() && all.Next())
+        split();
+    } else {
+      const char* q = p;  // where to search from
+      while (more() && re.Match(text, static_cast<size_t>(q - text.data()),
+                                text.size(), UNANCHORED, vec.data(), nvec)) {
+        split();
+        q = p;
+        if (vec[0].empty()) {
+          if (q == ep)
+            break;
+          q += SkipLength(re, q, ep);
+        }
+      }
+    }
+  }
+  pieces->emplace_back(p, static_cast<size_t>(ep - p));
+  return nsplit;
 }
 
 std::string RE2::QuoteMeta(absl::string_view unquoted) {
@@ -717,6 +1229,129 @@ static int ascii_strcasecmp(const char* a, const char* b, size_t len) {
 
 /***** Actual matching and rewriting code *****/
 
+bool RE2::LiteralMatch(absl::string_view text, Anchor re_anchor,
+                       absl::string_view* match) const {
+  const char* data = literal_.data();
+  size_t size = literal_.size();
+  if (text.size() < size)
+    return false;
+
+  // Returns whether the literal occurs at p.
+  auto equal = [&](const char* p) -> bool {
+    if (literal_foldcase_)
+      return ascii_strcasecmp(data, p, size) == 0;
+    return memcmp(data, p, size) == 0;
+  };
+
+  const char* p = text.data();
+  switch (re_anchor) {
+    default:
+      ABSL_LOG(DFATAL) << "Unexpected re_anchor value: " << re_anchor;
+      return false;
+
+    case ANCHOR_BOTH:
+      if (text.size() != size || !equal(p))
+        return false;
+      break;
+
+    case ANCHOR_START:
+      if (!equal(p))
+        return false;
+      break;
+
+    case UNANCHORED: {
+      // PrefixAccel() uses memchr(3), AVX2 or a "Shift DFA" as appropriate,
+      // so its candidates must be checked in full: only the first and last
+      // bytes have been compared when case-sensitive, and only the first
+      // (up to) nine bytes have been compared when case-insensitive.
+      const char* ep = text.data() + text.size();
+      for (;;) {
+        p = reinterpret_cast<const char*>(
+            prog_->PrefixAccel(p, static_cast<size_t>(ep - p)));
+        if (p == NULL || static_cast<size_t>(ep - p) < size)
+          return false;
+        if (equal(p))
+          break;
+        p++;
+      }
+      break;
+    }
+  }
+
+  if (match != NULL)
+    *match = absl::string_view(p, size);
+  return true;
+}
+
+bool RE2::InnerLiteralMatch(absl::string_view text, absl::string_view* subtext,
+                            absl::string_view* match, bool* matched) const {
+  Prog* prog = InnerReverseProg();
+  if (prog == NULL)
+    return false;
+
+  Prog::MatchKind kind =
+      longest_match_ ? Prog::kLongestMatch : Prog::kFirstMatch;
+  const char* bp = subtext->data();  // no match can begin before bp
+  const char* ep = subtext->data() + subtext->size();
+
+  // Where each literal next occurs, relative to the start of *subtext.
+  // These are only recomputed once the search has moved past them.
+  absl::FixedArray<size_t, 16> next(inner_literals_.size());
+  for (size_t i = 0; i < inner_literals_.size(); i++)
+    next[i] = subtext->find(inner_literals_[i]);
+  size_t from = 0;  // no occurrence that matters begins before from
+
+  int misses = 0;
+  for (;;) {
+    size_t n = absl::string_view::npos;
+    for (size_t i = 0; i < inner_literals_.size(); i++) {
+      if (next[i] != absl::string_view::npos && next[i] < from)
+        next[i] = subtext->find(inner_literals_[i], from);
+      n = std::min(n, next[i]);
+    }
+    if (n == absl::string_view::npos) {
+      *matched = false;
+      return true;
+    }
+    const char* hit = subtext->data() + n;
+    from = n + 1;
+
+    // Run inner_prefix_ backward from the occurrence to find where the
+    // leftmost match containing it would begin, then run the regexp
+    // forward from there to confirm the match and to find where it ends.
+    absl::string_view before(bp, static_cast<size_t>(hit - bp));
+    bool dfa_failed = false;
+    bool found_start = prog->SearchDFA(before, text, Prog::kAnchored,
+                                       Prog::kLongestMatch, &before,
+                                       &dfa_failed, NULL);
+    if (found_start) {
+      absl::string_view rest(before.data(),
+                             static_cast<size_t>(ep - before.data()));
+      if (prog_->SearchDFA(rest, text, Prog::kAnchored, kind,
+                           match, &dfa_failed, NULL)) {
+        *matched = true;
+        return true;
+      }
+    }
+    if (dfa_failed) {
+      *subtext = absl::string_view(bp, static_cast<size_t>(ep - bp));
+      return false;
+    }
+
+    // No match contains the occurrence.  None begins before it either and,
+    // if a match could have begun before it, none begins there.  Otherwise
+    // one still might and contain a later occurrence, as in ".exe.exe" for
+    // "[a-z.]+\.exe".
+    bp = found_start ? hit + 1 : hit;
+
+    // If such false positives are frequent, the DFA alone will be faster.
+    if (++misses >= 8 && hit - subtext->data() < 64 * misses) {
+      *subtext = absl::string_view(bp, static_cast<size_t>(ep - bp));
+      return false;
+    }
+  }
+}
+
 bool RE2::Match(absl::string_view text,
                 size_t startpos,
                 size_t endpos,
@@ -768,6 +1403,15 @@ bool RE2::Match(absl::string_view text,
   else if (prog_->anchor_start() && re_anchor != ANCHOR_BOTH)
     re_anchor = ANCHOR_START;
 
+  // A match can't be shorter than the regexp allows and, if it has to
+  // span the text, can't be longer either.  Length validators such as
+  // ^\w{1,64}$ thus reject text of the wrong length without a search.
+  if (subtext.size() < static_cast<size_t>(min_match_length_))
+    return false;
+  if (re_anchor == ANCHOR_BOTH && max_match_length_ >= 0 &&
+      subtext.size() > static_cast<size_t>(max_match_length_))
+    return false;
+
   // Check for the required prefix, if any.
   size_t prefixlen = 0;
   if (!prefix_.empty()) {
@@ -789,10 +1433,47 @@ bool RE2::Match(absl::string_view text,
       re_anchor = ANCHOR_START;
   }
 
+  if (is_literal_) {
+    // The regexp has no capturing groups, so ncap is at most one.
+    if (!LiteralMatch(subtext, re_anchor, ncap == 1 ? &submatch[0] : NULL))
+      return false;
+    for (int i = ncap; i < nsubmatch; i++)
+      submatch[i] = absl::string_view();
+    return true;
+  }
+
   Prog::Anchor anchor = Prog::kUnanchored;
   Prog::MatchKind kind =
       longest_match_ ? Prog::kLongestMatch : Prog::kFirstMatch;
 
+  // If the caller doesn't care where the match is or the match must span
+  // the text anyway, a small program can decide whether there is a match
+  // by simulating all of its threads at once without touching the DFA.
+  if (is_bit_parallel_ &&
+      (ncap == 0 || (ncap == 1 && re_anchor == ANCHOR_BOTH))) {
+    // Every match contains one of the inner_literals_, so if the text
+    // doesn't, there is no need to look any further.  (Not worth it for
+    // ANCHOR_START, which might otherwise be able to stop early.)
+    if (!inner_literals_.empty() && re_anchor != ANCHOR_START &&
+        std::none_of(inner_literals_.begin(), inner_literals_.end(),
+                     [&](const std::string& lit) {
+                       return subtext.find(lit) != absl::string_view::npos;
+                     }))
+      return false;
+    if (re_anchor == ANCHOR_BOTH)
+      kind = Prog::kFullMatch;
+    if (re_anchor != UNANCHORED)
+      anchor = Prog::kAnchored;
+    if (!prog_->SearchBitParallel(subtext, text, anchor, kind, NULL))
+      return false;
+    if (ncap == 1)
+      submatch[0] = absl::string_view(subtext.data() - prefixlen,
+                                      subtext.size() + prefixlen);
+    for (int i = ncap; i < nsubmatch; i++)
+      submatch[i] = absl::string_view();
+    return true;
+  }
+
   bool can_one_pass = is_one_pass_ && ncap <= Prog::kMaxOnePassCapture;
   bool can_bit_state = prog_->CanBitState();
   size_t bit_state_text_max_size = prog_->bit_state_text_max_size();
@@ -813,7 +1494,7 @@ bool RE2::Match(absl::string_view text,
         // we already know where the match must end! Instead, the reverse DFA
         // can say whether there is a match and (optionally) where it starts.
         Prog* prog = ReverseProg();
-        if (prog == NULL) {
+        if (prog == NULL || prog->ShouldSkipDFA()) {
           // Fall back to NFA below.
           skipped_test = true;
           break;
@@ -838,6 +1519,35 @@ bool RE2::Match(absl::string_view text,
         break;
       }
 
+      // If the DFA keeps failing on the inputs seen lately, don't waste
+      // time on it: it only gives up and leaves the work to the NFA.
+      if (prog_->ShouldSkipDFA()) {
+        skipped_test = true;
+        break;
+      }
+
+      if (!inner_literals_.empty()) {
+        // This finds exactly where the match is (or that there isn't one)
+        // unless it gives up, in which case we continue as usual below.
+        bool matched;
+        if (InnerLiteralMatch(text, &subtext, matchp, &matched)) {
+          if (!matched)
+            return false;
+          if (matchp == NULL)  // Matched.  Don't care where.
+            return true;
+          break;
+        }
+      }
+
+      // If the caller doesn't care where the match is, a small DFA can be
+      // flattened into a table and run without the overhead of the cache.
+      // (Not worth it if the DFA can accelerate past the prefix anyway.)
+      bool matched;
+      if (matchp == NULL && inner_literals_.empty() &&
+          !prog_->can_prefix_accel() &&
+          prog_->SearchFlatDFA(subtext, text, &matched))
+        return matched;
+
       if (!prog_->SearchDFA(subtext, text, anchor, kind,
                             matchp, &dfa_failed, NULL)) {
         if (dfa_failed) {
@@ -859,7 +1569,7 @@ bool RE2::Match(absl::string_view text,
       // match started.  Run the regexp backward from match.end()
       // to find the longest possible match -- that's where it started.
       Prog* prog = ReverseProg();
-      if (prog == NULL) {
+      if (prog == NULL || prog->ShouldSkipDFA()) {
         // Fall back to NFA below.
         skipped_test = true;
         break;
@@ -907,6 +1617,10 @@ bool RE2::Match(absl::string_view text,
         skipped_test = true;
         break;
       }
+      if (prog_->ShouldSkipDFA()) {
+        skipped_test = true;
+        break;
+      }
       if (!prog_->SearchDFA(subtext, text, anchor, kind,
                             &match, &dfa_failed, NULL)) {
         if (dfa_failed) {
@@ -977,6 +1691,244 @@ bool RE2::Match(absl::string_view text,
   return true;
 }
 
+bool RE2::MatchChunks(const absl::string_view* chunks,
+                      int nchunks,
+                      Anchor re_anchor,
+                      absl::string_view* submatch,
+                      int nsubmatch,
+                      std::string* buf,
+                      size_t* pos) const {
+  ABSL_DCHECK(buf != NULL || nsubmatch == 0);
+  if (!ok()) {
+    if (options_.log_errors())
+      ABSL_LOG(ERROR) << "Invalid RE2: " << *error_;
+    return false;
+  }
+
+  // Text in just one chunk needs no special care.
+  size_t size = 0;
+  int nonempty = 0;
+  absl::string_view text = nchunks > 0 ? chunks[0] : absl::string_view();
+  for (int i = 0; i < nchunks; i++) {
+    size += chunks[i].size();
+    if (!chunks[i].empty()) {
+      nonempty++;
+      text = chunks[i];
+    }
+  }
+  if (nonempty <= 1) {
+    if (!Match(text, 0, text.size(), re_anchor, submatch, nsubmatch))
+      return false;
+    if (pos != NULL && nsubmatch > 0)
+      *pos = static_cast<size_t>(submatch[0].data() - text.data());
+    return true;
+  }
+
+  // Check for the required prefix, if any, piece by piece.  prog_ is
+  // for what follows it, so the search has to begin after it.
+  size_t prefixlen = prefix_.size();
+  if (prefixlen > size)
+    return false;
+  for (int i = 0, n = 0; n < static_cast<int>(prefixlen); i++) {
+    size_t len = std::min(chunks[i].size(), prefixlen - n);
+    if (len == 0)
+      continue;
+    if (prefix_foldcase_) {
+      if (ascii_strcasecmp(&prefix_[n], chunks[i].data(), len) != 0)
+        return false;
+    } else {
+      if (memcmp(&prefix_[n], chunks[i].data(), len) != 0)
+        return false;
+    }
+    n += static_cast<int>(len);
+  }
+  if (prefixlen > 0 && re_anchor == UNANCHORED)
+    re_anchor = ANCHOR_START;
+
+  // Run the DFAs over the chunks to find where the match is, forward
+  // to find where it ends and, if need be, backward to find where it
+  // begins.
+  Prog::Anchor anchor =
+      re_anchor == UNANCHORED ? Prog::kUnanchored : Prog::kAnchored;
+  Prog::MatchKind kind =
+      longest_match_ ? Prog::kLongestMatch : Prog::kFirstMatch;
+  if (re_anchor == ANCHOR_BOTH)
+    kind = Prog::kFullMatch;
+  size_t begin = 0;
+  size_t end = 0;
+  bool dfa_failed = false;
+  if (!prog_->ShouldSkipDFA()) {
+    if (!prog_->SearchDFAChunks(chunks, nchunks, prefixlen, size, anchor,
+                                kind, nsubmatch > 0 ? &end : NULL,
+                                &dfa_failed) &&
+        !dfa_failed)
+      return false;
+    if (!dfa_failed && nsubmatch == 0)  // Matched.  Don't care where.
+      return true;
+    if (!dfa_failed && anchor == Prog::kUnanchored &&
+        !prog_->anchor_start()) {
+      Prog* prog = ReverseProg();
+      if (prog == NULL || prog->ShouldSkipDFA()) {
+        dfa_failed = true;
+      } else if (!prog->SearchDFAChunks(chunks, nchunks, 0, end,
+                                        Prog::kAnchored, Prog::kLongestMatch,
+                                        &begin, &dfa_failed) &&
+                 !dfa_failed) {
+        if (options_.log_errors())
+          ABSL_LOG(ERROR) << "SearchDFAChunks inconsistency";
+        return false;
+      }
+    }
+  } else {
+    dfa_failed = true;
+  }
+
+  if (dfa_failed) {
+    // Give up on the chunks and do it the slow way.
+    std::string tmp;
+    std::string* s = buf != NULL ? buf : &tmp;
+    s->clear();
+    s->reserve(size);
+    for (int i = 0; i < nchunks; i++)
+      s->append(chunks[i].data(), chunks[i].size());
+    if (!Match(*s, 0, s->size(), re_anchor, submatch, nsubmatch))
+      return false;
+    if (pos != NULL && nsubmatch > 0)
+      *pos = static_cast<size_t>(submatch[0].data() - s->data());
+    return true;
+  }
+
+  // Find the match and a byte either side of it in one chunk or else
+  // copy them into *buf.  Then Match() can find the submatches in that
+  // much of the text as it would in all of it.
+  size_t lo = begin > 0 ? begin-1 : 0;
+  size_t hi = end < size ? end+1 : size;
+  absl::string_view context;
+  size_t off = 0;
+  for (int i = 0; i < nchunks; i++) {
+    if (off <= lo && hi <= off + chunks[i].size()) {
+      context = chunks[i].substr(lo - off, hi - lo);
+      break;
+    }
+    off += chunks[i].size();
+  }
+  if (context.data() == NULL) {
+    buf->clear();
+    off = 0;
+    for (int i = 0; i < nchunks; i++) {
+      size_t n = chunks[i].size();
+      if (off < hi && lo < off + n) {
+        size_t b = std::max(lo, off) - off;
+        size_t e = std::min(hi, off + n) - off;
+        buf->append(chunks[i].data() + b, e - b);
+      }
+      off += n;
+    }
+    context = *buf;
+  }
+  if (!Match(context, begin - lo, end - lo, ANCHOR_BOTH,
+             submatch, nsubmatch)) {
+    if (options_.log_errors())
+      ABSL_LOG(ERROR) << "MatchChunks inconsistency";
+    return false;
+  }
+  if (pos != NULL)
+    *pos = begin;
+  return true;
+}
+
+int RE2::MatchSuccessive(absl::string_view text, size_t startpos,
+                         const char* lastend, absl::string_view* submatch,
+                         int nsubmatch, int n) const {
+  // Only the plain case of running the DFAs forward and then backward
+  // is worth batching; the others are left to Match().
+  if (!ok() || is_literal_ || !prefix_.empty() || !inner_literals_.empty() ||
+      prog_->anchor_start() || prog_->anchor_end() || nsubmatch < 1 ||
+      startpos > text.size() || prog_->ShouldSkipDFA())
+    return -1;
+  Prog* prog = ReverseProg();
+  if (prog == NULL || prog->ShouldSkipDFA())
+    return -1;
+
+  int ncap = 1 + NumberOfCapturingGroups();
+  if (ncap > nsubmatch)
+    ncap = nsubmatch;
+  Prog::MatchKind kind =
+      longest_match_ ? Prog::kLongestMatch : Prog::kFirstMatch;
+
+#ifdef RE2_HAVE_THREAD_LOCAL
+  hooks::context = this;
+#endif
+  // Find where each match ends, noting where each search began,
+  // and then where each match begins.  The spans are kept in the last
+  // n elements of submatch, so that filling in the submatches of match i
+  // overwrites none of the spans after it (and so that nothing has to
+  // be allocated, however big the batch).
+  absl::string_view* match = &submatch[n * (nsubmatch - 1)];
+  const char* p = text.data() + startpos;
+  const char* ep = text.data() + text.size();
+  int nmatch = 0;
+  bool dfa_failed = false;
+  while (nmatch < n) {
+    bool skip;
+    int k = prog_->SearchDFASuccessive(
+        absl::string_view(p, static_cast<size_t>(ep - p)), text, kind,
+        lastend, &match[nmatch], n - nmatch, &skip, &dfa_failed);
+    if (dfa_failed)
+      return -1;
+    nmatch += k;
+    if (k > 0)
+      p = lastend = match[nmatch-1].data() + match[nmatch-1].size();
+    if (!skip)
+      break;
+    p += SkipLength(*this, p, ep);
+    if (p > ep)
+      break;
+  }
+  if (nmatch > 0 &&
+      !prog->SearchDFAAnchoredEach(text, match, nmatch, &dfa_failed)) {
+    if (!dfa_failed && options_.log_errors())
+      ABSL_LOG(ERROR) << "SearchDFA inconsistency";
+    return -1;
+  }
+
+  bool can_one_pass = is_one_pass_ && ncap <= Prog::kMaxOnePassCapture;
+  bool can_bit_state = prog_->CanBitState();
+  size_t bit_state_text_max_size = prog_->bit_state_text_max_size();
+  for (int i = 0; i < nmatch; i++) {
+    absl::string_view* sub = &submatch[i * nsubmatch];
+    absl::string_view m = match[i];
+    if (ncap <= 1) {
+      sub[0] = m;
+    } else if (can_one_pass) {
+      if (!prog_->SearchOnePass(m, text, Prog::kAnchored,
+                                Prog::kFullMatch, sub, ncap)) {
+        if (options_.log_errors())
+          ABSL_LOG(ERROR) << "SearchOnePass inconsistency";
+        return -1;
+      }
+    } else if (can_bit_state && m.size() <= bit_state_text_max_size) {
+      if (!prog_->SearchBitState(m, text, Prog::kAnchored,
+                                 Prog::kFullMatch, sub, ncap)) {
+        if (options_.log_errors())
+          ABSL_LOG(ERROR) << "SearchBitState inconsistency";
+        return -1;
+      }
+    } else {
+      if (!prog_->SearchNFA(m, text, Prog::kAnchored,
+                            Prog::kFullMatch, sub, ncap)) {
+        if (options_.log_errors())
+          ABSL_LOG(ERROR) << "SearchNFA inconsistency";
+        return -1;
+      }
+    }
+    // Zero submatches that don't exist in the regexp.
+    for (int j = ncap; j < nsubmatch; j++)
+      sub[j] = absl::string_view();
+  }
+  return nmatch;
+}
+
 // Internal matcher - like Match() but takes Args not string_views.
 bool RE2::DoMatch(absl::string_view text,
                   Anchor re_anchor,
@@ -1124,6 +2076,51 @@ bool RE2::Rewrite(std::string* out,
   return true;
 }
 
+RE2::RewriteTemplate::RewriteTemplate(const RE2& re,
+                                      absl::string_view rewrite)
+    : max_submatch_(0) {
+  if (!re.CheckRewriteString(rewrite, &error_)) {
+    // CheckRewriteString() always explains itself, but make sure.
+    if (error_.empty())
+      error_ = "invalid rewrite string";
+    return;
+  }
+  text_.reserve(rewrite.size());
+  size_t len = 0;
+  for (const char *s = rewrite.data(), *end = s + rewrite.size();
+       s < end; s++) {
+    if (*s != '\\') {
+      text_.push_back(*s);
+      len++;
+      continue;
+    }
+    s++;  // CheckRewriteString() ensured that there is another character.
+    if (*s == '\\') {
+      text_.push_back('\\');
+      len++;
+      continue;
+    }
+    int n = *s - '0';
+    pieces_.push_back({len, n});
+    len = 0;
+    if (n > max_submatch_)
+      max_submatch_ = n;
+  }
+  if (len > 0)
+    pieces_.push_back({len, -1});
+}
+
+void RE2::RewriteTemplate::Rewrite(std::string* out,
+                                   const absl::string_view* vec) const {
+  const char* p = text_.data();
+  for (const Piece& piece : pieces_) {
+    out->append(p, piece.len);
+    p += piece.len;
+    if (piece.n >= 0 && !vec[piece.n].empty())
+      out->append(vec[piece.n].data(), vec[piece.n].size());
+  }
+}
+
 /***** Parsers for various types *****/
 
 namespace re2_internal {
@@ -1172,207 +2169,138 @@ bool Parse(const char* str, size_t n, unsigned char* dest) {
   return true;
 }
 
-// Largest number spec that we are willing to parse
-static const int kMaxNumberLength = 32;
-
-// REQUIRES "buf" must have length at least nbuf.
-// Copies "str" into "buf" and null-terminates.
-// Overwrites *np with the new length.
-static const char* TerminateNumber(char* buf, size_t nbuf, const char* str,
-                                   size_t* np, bool accept_spaces) {
-  size_t n = *np;
-  if (n == 0) return "";
-  if (n > 0 && absl::ascii_isspace(*str)) {
-    // We are less forgiving than the strtoxxx() routines and do not
-    // allow leading spaces. We do allow leading spaces for floats.
-    if (!accept_spaces) {
-      return "";
-    }
-    while (n > 0 && absl::ascii_isspace(*str)) {
-      n--;
-      str++;
-    }
-  }
-
-  // Although buf has a fixed maximum size, we can still handle
-  // arbitrarily large integers correctly by omitting leading zeros.
-  // (Numbers that are still too long will be out of range.)
-  // Before deciding whether str is too long,
-  // remove leading zeros with s/000+/00/.
-  // Leaving the leading two zeros in place means that
-  // we don't change 0000x123 (invalid) into 0x123 (valid).
-  // Skip over leading - before replacing.
+// Parses str[0, n) as a floating-point number, as strtod() would, except
+// that only leading spaces, not trailing ones, are allowed and that the
+// locale doesn't matter.  absl::from_chars() parses from the span as is,
+// so there is nothing to copy or NUL-terminate; it doesn't accept a '+',
+// though, nor a "0x" before a hexadecimal number, so those are dealt with
+// here.
+template <typename T>
+static bool ParseFloat(const char* str, size_t n, T* dest) {
+  const char* end = str + n;
+  while (str < end && absl::ascii_isspace(*str))
+    str++;
   bool neg = false;
-  if (n >= 1 && str[0] == '-') {
-    neg = true;
-    n--;
+  if (str < end && (*str == '-' || *str == '+')) {
+    neg = *str == '-';
     str++;
+    if (str < end && (*str == '-' || *str == '+'))
+      return false;
   }
-
-  if (n >= 3 && str[0] == '0' && str[1] == '0') {
-    while (n >= 3 && str[2] == '0') {
-      n--;
-      str++;
-    }
-  }
-
-  if (neg) {  // make room in buf for -
-    n++;
-    str--;
-  }
-
-  if (n > nbuf-1) return "";
-
-  memmove(buf, str, n);
-  if (neg) {
-    buf[0] = '-';
+  absl::chars_format fmt = absl::chars_format::general;
+  if (end - str > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X') &&
+      (absl::ascii_isxdigit(str[2]) || str[2] == '.')) {
+    fmt = absl::chars_format::hex;
+    str += 2;
   }
-  buf[n] = '\0';
-  *np = n;
-  return buf;
+  T r;
+  absl::from_chars_result res = absl::from_chars(str, end, r, fmt);
+  if (res.ptr != end) return false;   // Leftover junk
+  if (res.ec != std::errc()) return false;
+  if (dest == NULL) return true;
+  *dest = neg ? -r : r;
+  return true;
 }
 
 template <>
 bool Parse(const char* str, size_t n, float* dest) {
-  if (n == 0) return false;
-  static const int kMaxLength = 200;
-  char buf[kMaxLength+1];
-  str = TerminateNumber(buf, sizeof buf, str, &n, true);
-  char* end;
-  errno = 0;
-  float r = strtof(str, &end);
-  if (end != str + n) return false;   // Leftover junk
-  if (errno) return false;
-  if (dest == NULL) return true;
-  *dest = r;
-  return true;
+  return ParseFloat(str, n, dest);
 }
 
 template <>
 bool Parse(const char* str, size_t n, double* dest) {
-  if (n == 0) return false;
-  static const int kMaxLength = 200;
-  char buf[kMaxLength+1];
-  str = TerminateNumber(buf, sizeof buf, str, &n, true);
-  char* end;
-  errno = 0;
-  double r = strtod(str, &end);
-  if (end != str + n) return false;   // Leftover junk
-  if (errno) return false;
+  return ParseFloat(str, n, dest);
+}
+
+// Parses str[0, n) as an integer of type T, as strtol() and friends would
+// with the given radix, except that leading spaces are not allowed and that
+// negative numbers are errors for unsigned types (which strtoul() would
+// silently accept and negate).  Radix 0 means as in C: hexadecimal after
+// "0x", octal after "0" and decimal otherwise.  The digits are accumulated
+// straight from the span, so there is nothing to copy or NUL-terminate and
+// arbitrarily many leading zeros are fine.
+template <typename T>
+static bool ParseInteger(const char* str, size_t n, T* dest, int radix) {
+  typedef typename std::make_unsigned<T>::type U;
+  const char* end = str + n;
+  bool neg = false;
+  if (str < end && (*str == '-' || *str == '+')) {
+    neg = *str == '-';
+    if (neg && !std::is_signed<T>::value)
+      return false;
+    str++;
+  }
+  if ((radix == 0 || radix == 16) && end - str > 2 && str[0] == '0' &&
+      (str[1] == 'x' || str[1] == 'X')) {
+    radix = 16;
+    str += 2;
+  } else if (radix == 0) {
+    radix = str < end && str[0] == '0' ? 8 : 10;
+  }
+  if (str == end) return false;
+
+  // The magnitude of the most negative number is one more than that of the
+  // most positive number, which is representable as U.
+  U max = static_cast<U>(std::numeric_limits<T>::max());
+  if (neg)
+    max++;
+  U r = 0;
+  for (; str < end; str++) {
+    int c = *str;
+    int d;
+    if ('0' <= c && c <= '9')
+      d = c - '0';
+    else if ('a' <= (c | 0x20) && (c | 0x20) <= 'z')
+      d = (c | 0x20) - 'a' + 10;
+    else
+      return false;
+    if (d >= radix) return false;
+    if (r > (max - d) / radix) return false;  // Out of range
+    r = r * radix + d;
+  }
   if (dest == NULL) return true;
-  *dest = r;
+  *dest = static_cast<T>(neg ? 0 - r : r);
   return true;
 }
 
 template <>
 bool Parse(const char* str, size_t n, long* dest, int radix) {
-  if (n == 0) return false;
-  char buf[kMaxNumberLength+1];
-  str = TerminateNumber(buf, sizeof buf, str, &n, false);
-  char* end;
-  errno = 0;
-  long r = strtol(str, &end, radix);
-  if (end != str + n) return false;   // Leftover junk
-  if (errno) return false;
-  if (dest == NULL) return true;
-  *dest = r;
-  return true;
+  return ParseInteger(str, n, dest, radix);
 }
 
 template <>
 bool Parse(const char* str, size_t n, unsigned long* dest, int radix) {
-  if (n == 0) return false;
-  char buf[kMaxNumberLength+1];
-  str = TerminateNumber(buf, sizeof buf, str, &n, false);
-  if (str[0] == '-') {
-    // strtoul() will silently accept negative numbers and parse
-    // them.  This module is more strict and treats them as errors.
-    return false;
-  }
-
-  char* end;
-  errno = 0;
-  unsigned long r = strtoul(str, &end, radix);
-  if (end != str + n) return false;   // Leftover junk
-  if (errno) return false;
-  if (dest == NULL) return true;
-  *dest = r;
-  return true;
+  return ParseInteger(str, n, dest, radix);
 }
 
 template <>
 bool Parse(const char* str, size_t n, short* dest, int radix) {
-  long r;
-  if (!Parse(str, n, &r, radix)) return false;  // Could not parse
-  if ((short)r != r) return false;              // Out of range
-  if (dest == NULL) return true;
-  *dest = (short)r;
-  return true;
+  return ParseInteger(str, n, dest, radix);
 }
 
 template <>
 bool Parse(const char* str, size_t n, unsigned short* dest, int radix) {
-  unsigned long r;
-  if (!Parse(str, n, &r, radix)) return false;  // Could not parse
-  if ((unsigned short)r != r) return false;     // Out of range
-  if (dest == NULL) return true;
-  *dest = (unsigned short)r;
-  return true;
+  return ParseInteger(str, n, dest, radix);
 }
 
 template <>
 bool Parse(const char* str, size_t n, int* dest, int radix) {
-  long r;
-  if (!Parse(str, n, &r, radix)) return false;  // Could not parse
-  if ((int)r != r) return false;                // Out of range
-  if (dest == NULL) return true;
-  *dest = (int)r;
-  return true;
+  return ParseInteger(str, n, dest, radix);
 }
 
 template <>
 bool Parse(const char* str, size_t n, unsigned int* dest, int radix) {
-  unsigned long r;
-  if (!Parse(str, n, &r, radix)) return false;  // Could not parse
-  if ((unsigned int)r != r) return false;       // Out of range
-  if (dest == NULL) return true;
-  *dest = (unsigned int)r;
-  return true;
+  return ParseInteger(str, n, dest, radix);
 }
 
 template <>
 bool Parse(const char* str, size_t n, long long* dest, int radix) {
-  if (n == 0) return false;
-  char buf[kMaxNumberLength+1];
-  str = TerminateNumber(buf, sizeof buf, str, &n, false);
-  char* end;
-  errno = 0;
-  long long r = strtoll(str, &end, radix);
-  if (end != str + n) return false;   // Leftover junk
-  if (errno) return false;
-  if (dest == NULL) return true;
-  *dest = r;
-  return true;
+  return ParseInteger(str, n, dest, radix);
 }
 
 template <>
 bool Parse(const char* str, size_t n, unsigned long long* dest, int radix) {
-  if (n == 0) return false;
-  char buf[kMaxNumberLength+1];
-  str = TerminateNumber(buf, sizeof buf, str, &n, false);
-  if (str[0] == '-') {
-    // strtoull() will silently accept negative numbers and parse
-    // them.  This module is more strict and treats them as errors.
-    return false;
-  }
-  char* end;
-  errno = 0;
-  unsigned long long r = strtoull(str, &end, radix);
-  if (end != str + n) return false;   // Leftover junk
-  if (errno) return false;
-  if (dest == NULL) return true;
-  *dest = r;
-  return true;
+  return ParseInteger(str, n, dest, radix);
 }
 
 }  // namespace re2_internal
@@ -212,7 +212,10 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <functional>
+#include <iterator>
 #include <map>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -245,6 +248,32 @@ class RE2 {
   // Defined in set.h.
   class Set;
 
+  // Defined in replace_set.h.
+  class ReplaceSet;
+
+  // Defined in lexer.h.
+  class Lexer;
+
+  // Defined in submatcher.h.
+  class Submatcher;
+
+  // Defined in cache.h.
+  class Cache;
+
+  // A rewrite string for Replace(), GlobalReplace() and Extract(),
+  // compiled once up front.  Defined below.
+  class RewriteTemplate;
+
+  // The successive matches of a regexp in some text.  Defined below.
+  class FindAll;
+
+  // Calls fn(i) for every i in [0, n), possibly concurrently on threads of
+  // the caller's choosing, and returns once all of those calls have returned.
+  // RE2::Set and FilteredRE2 accept one of these so that they can spread
+  // the work of building them for many regexps across a thread pool.
+  using ParallelFor =
+      std::function<void(int n, const std::function<void(int i)>& fn)>;
+
   enum ErrorCode {
     NoError = 0,
 
@@ -303,6 +332,17 @@ class RE2 {
   RE2(RE2&&) = delete;
   RE2& operator=(RE2&&) = delete;
 
+  // Returns an RE2 that matches any one of words, like the one for the
+  // pattern that joins them with | after escaping them with QuoteMeta(),
+  // which is what pattern() returns, but without parsing that pattern:
+  // the words are laid out as a trie instead, which for long lists of
+  // words takes much less time and memory and makes for a smaller program.
+  // options.case_sensitive(), options.never_nl() and options.encoding()
+  // apply to the words as usual; options.literal() is implied.
+  // Use FullMatch() or RE2::ANCHOR_BOTH to match whole words only.
+  static std::unique_ptr<RE2> FromWords(const std::vector<std::string>& words,
+                                        const Options& options);
+
   // Returns whether RE2 was created properly.
   bool ok() const { return error_code() == NoError; }
 
@@ -464,6 +504,14 @@ class RE2 {
     return Apply(FindAndConsumeN, input, re, Arg(std::forward<A>(a))...);
   }
 
+  // To go through all of the matches of "re" in "text" without parsing
+  // them into Args as FindAndConsume() does, use FindAll instead:
+  //
+  //   absl::string_view sub[2];
+  //   for (const absl::string_view* m : RE2::FindAll(text, re, sub, 2)) {
+  //     // m[0] is the match and m[1] is the first parenthesized group.
+  //   }
+
   // Replace the first match of "re" in "str" with "rewrite".
   // Within "rewrite", backslash-escaped digits (\1 to \9) can be
   // used to insert text matching corresponding parenthesized group
@@ -493,11 +541,36 @@ class RE2 {
   // Because GlobalReplace only replaces non-overlapping matches,
   // replacing "ana" within "banana" makes only one replacement, not two.
   //
+  // The replacements are made in place, so "str" isn't copied unless
+  // they make the text longer: only the part of the result that would
+  // overtake the text not yet searched is kept aside.
+  //
   // Returns the number of replacements made.
   static int GlobalReplace(std::string* str,
                            const RE2& re,
                            absl::string_view rewrite);
 
+  // Like GlobalReplace(), except that instead of replacing "text",
+  // passes the result to "sink" a piece at a time, so that it can go
+  // straight to wherever it is needed without being put together in
+  // a std::string first.  E.g.
+  //
+  //   absl::Cord cord;
+  //   RE2::GlobalReplace(text, "b+", "d",
+  //                      [&](absl::string_view s) { cord.Append(s); });
+  //
+  // All of the result is passed, even if there are no replacements.
+  // A sink that writes to a fixed buffer has to note any overflow itself.
+  //
+  // Returns the number of replacements made, or -1 if "rewrite" refers
+  // to more parenthesized groups than "re" has, in which case nothing is
+  // passed to "sink".
+  using ReplaceSink = std::function<void(absl::string_view piece)>;
+  static int GlobalReplace(absl::string_view text,
+                           const RE2& re,
+                           absl::string_view rewrite,
+                           const ReplaceSink& sink);
+
   // Like Replace, except that if the pattern matches, "rewrite"
   // is copied into "out" with substitutions.  The non-matching
   // portions of "text" are ignored.
@@ -511,6 +584,52 @@ class RE2 {
                       absl::string_view rewrite,
                       std::string* out);
 
+  // Like the above, but with a precompiled rewrite, which spares checking
+  // and parsing the rewrite string on every call and for every match.
+  // Fail (GlobalReplace() returns 0, or -1 with a sink) if !rewrite.ok()
+  // or if it refers to more parenthesized groups than re has.
+  static bool Replace(std::string* str,
+                      const RE2& re,
+                      const RewriteTemplate& rewrite);
+  static int GlobalReplace(std::string* str,
+                           const RE2& re,
+                           const RewriteTemplate& rewrite);
+  static int GlobalReplace(absl::string_view text,
+                           const RE2& re,
+                           const RewriteTemplate& rewrite,
+                           const ReplaceSink& sink);
+  static bool Extract(absl::string_view text,
+                      const RE2& re,
+                      const RewriteTemplate& rewrite,
+                      std::string* out);
+
+  // Splits "text" around the matches of "re" much as Python's re.split()
+  // does, but see below for how empty matches differ.  Appends to "*pieces"
+  // the text before each match, then the text of each of the parenthesized
+  // groups of "re" (with data() == NULL for any that didn't participate in
+  // the match) and finally the text after the last match.  E.g.
+  //
+  //   std::vector<absl::string_view> pieces;
+  //   RE2::Split("a, b,,c", "(,) *", 0, &pieces);
+  //
+  // will leave "pieces" containing "a", ",", "b", ",", "", ",", "c".
+  //
+  // Makes at most "maxsplit" splits if "maxsplit" is positive, and none
+  // at all if it is negative.  As with Python, empty matches split the
+  // text too, even right after another match.  Unlike Python, after an
+  // empty match the search resumes one character further on, so a
+  // non-empty match at the same position is never found: splitting "ab"
+  // on "|a" gives "", "a", "b", "" here but "", "", "", "b", "" in Python.
+  // RE2 can't ask for the preferred match that isn't empty, so this is
+  // how RE2::GlobalReplace() steps past empty matches too.  The pieces
+  // point into "text", so nothing is copied.
+  //
+  // Returns the number of splits made.
+  static int Split(absl::string_view text,
+                   const RE2& re,
+                   int maxsplit,
+                   std::vector<absl::string_view>* pieces);
+
   // Escapes all potentially meaningful regexp characters in
   // 'unquoted'.  The returned string, used as a regular expression,
   // will match exactly the original string.  For example,
@@ -589,6 +708,28 @@ class RE2 {
              absl::string_view* submatch,
              int nsubmatch) const;
 
+  // Like Match(), but for text that is split into chunks[0, nchunks),
+  // such as the pieces of an absl::Cord (see absl::Cord::Chunks()) or of
+  // an iovec array, and searched as though the chunks were one string.
+  // The chunks are not copied: the DFAs run over them where they are.
+  // Only the match itself is made contiguous for submatch[], if needed:
+  // when it lies within one chunk, submatch[] points into that chunk;
+  // when it crosses from one chunk into another, it is copied into *buf
+  // (with a byte either side, for the sake of \b and the like) and
+  // submatch[] points into that.  On a successful match, sets *pos (if
+  // non-NULL and nsubmatch > 0) to the offset of submatch[0] from the
+  // start of the text.  buf may be NULL if nsubmatch == 0.
+  //
+  // If the DFA runs out of memory, falls back to copying all of the
+  // chunks into *buf and calling Match().
+  bool MatchChunks(const absl::string_view* chunks,
+                   int nchunks,
+                   Anchor re_anchor,
+                   absl::string_view* submatch,
+                   int nsubmatch,
+                   std::string* buf,
+                   size_t* pos) const;
+
   // Check that the given rewrite string is suitable for use with this
   // regular expression.  It checks that:
   //   * The regular expression has enough parenthesized subexpressions
@@ -773,7 +914,13 @@ class RE2 {
   static void LogUserMessage(const char* message);
 
  private:
-  void Init(absl::string_view pattern, const Options& options);
+  // Parses pattern or, if words isn't NULL, builds the regexp from words
+  // with pattern being just for show.
+  RE2(absl::string_view pattern, const Options& options,
+      const std::vector<std::string>* words);
+
+  void Init(absl::string_view pattern, const Options& options,
+            const std::vector<std::string>* words);
 
   bool DoMatch(absl::string_view text,
                Anchor re_anchor,
@@ -782,6 +929,49 @@ class RE2 {
                int n) const;
 
   re2::Prog* ReverseProg() const;
+  re2::Prog* InnerReverseProg() const;
+
+  // Searches text for literal_, which is the entire regexp,
+  // without running prog_ at all.
+  bool LiteralMatch(absl::string_view text, Anchor re_anchor,
+                    absl::string_view* match) const;
+
+  // Searches *subtext for the leftmost match by looking for occurrences
+  // of inner_literals_ and running the automata around them.  Returns
+  // false if the caller should search *subtext by other means instead;
+  // it might have been shortened to skip text that cannot begin a match.
+  // Otherwise, sets *matched and, if it is true and match isn't NULL,
+  // sets *match.
+  bool InnerLiteralMatch(absl::string_view text, absl::string_view* subtext,
+                         absl::string_view* match, bool* matched) const;
+
+  // Finds up to n successive, non-overlapping, unanchored matches in text
+  // starting at offset startpos, as many calls to Match() would, except
+  // that an empty match ending at lastend is skipped.  Match i fills in
+  // submatch[i*nsubmatch, (i+1)*nsubmatch).  Returns the number of matches
+  // found, which is less than n only if there are no more, or -1 if the
+  // caller should use Match() instead.  Saves taking the DFA cache locks
+  // over and over again when the matches are many and short.
+  // submatch[] is also used as scratch space, even if there is no match.
+  int MatchSuccessive(absl::string_view text, size_t startpos,
+                      const char* lastend, absl::string_view* submatch,
+                      int nsubmatch, int n) const;
+
+  // GlobalReplace() with a function that appends the rewrite of the match
+  // in vec[0, nvec) to out.  For RE2::ReplaceSet.
+  using RewriteFunction =
+      std::function<bool(std::string* out, const absl::string_view* vec)>;
+  static int GlobalReplaceWith(std::string* str, const RE2& re, int nvec,
+                               const RewriteFunction& rewrite);
+  static int GlobalReplaceWith(absl::string_view text, const RE2& re,
+                               int nvec, const RewriteFunction& rewrite,
+                               const ReplaceSink& sink);
+
+  // Does the work of GlobalReplace(), passing the result to out.
+  // Returns the number of replacements made, or -1 if nvec is too big.
+  template <typename Output>
+  static int GlobalReplaceImpl(absl::string_view text, const RE2& re,
+                               int nvec, Output* out);
 
   // First cache line is relatively cold fields.
   const std::string* pattern_;    // string regular expression
@@ -794,21 +984,32 @@ class RE2 {
   // Second cache line is relatively hot fields.
   // These are ordered oddly to pack everything.
   int num_captures_;              // number of capturing groups
-  ErrorCode error_code_ : 29;     // error code (29 bits is more than enough)
+  ErrorCode error_code_ : 26;     // error code (26 bits is more than enough)
   bool longest_match_ : 1;        // cached copy of options_.longest_match()
   bool is_one_pass_ : 1;          // can use prog_->SearchOnePass?
+  bool is_bit_parallel_ : 1;      // can use prog_->SearchBitParallel?
   bool prefix_foldcase_ : 1;      // prefix_ is ASCII case-insensitive
+  bool is_literal_ : 1;           // can use LiteralMatch instead of prog_?
+  bool literal_foldcase_ : 1;     // literal_ is ASCII case-insensitive
+  int min_match_length_;          // least number of bytes in a match
+  int max_match_length_;          // greatest, or -1 if there is no limit
   std::string prefix_;            // required prefix (before suffix_regexp_)
+  std::string literal_;           // entire regexp, if it is a literal string
+  std::vector<std::string> inner_literals_;  // one is in every match
+  re2::Regexp* inner_prefix_;     // part of suffix_regexp_ before them
   re2::Prog* prog_;               // compiled program for regexp
 
   // Reverse Prog for DFA execution only
   mutable re2::Prog* rprog_;
+  // Reverse Prog for inner_prefix_, if InnerLiteralMatch can use it
+  mutable re2::Prog* inner_rprog_;
   // Map from capture names to indices
   mutable const std::map<std::string, int>* named_groups_;
   // Map from capture indices to names
   mutable const std::map<int, std::string>* group_names_;
 
   mutable absl::once_flag rprog_once_;
+  mutable absl::once_flag inner_rprog_once_;
   mutable absl::once_flag named_groups_once_;
   mutable absl::once_flag group_names_once_;
 };
@@ -949,6 +1150,132 @@ class RE2::Arg {
   Parser        parser_;
 };
 
+// A RewriteTemplate is a rewrite string that has been checked and broken
+// into literal text and \N substitutions once, instead of on every call to
+// Replace(), GlobalReplace() or Extract() and for every match.  That pays
+// off when the same rewrite is used over and over:
+//
+//    static const RE2 re("(\\w+)@(\\w+)");
+//    static const RE2::RewriteTemplate rewrite(re, "\\1 at \\2");
+//    RE2::GlobalReplace(&s, re, rewrite);
+//
+// A RewriteTemplate is immutable and therefore safe for concurrent use.
+class RE2::RewriteTemplate {
+ public:
+  // Compiles rewrite for use with re.  If re.CheckRewriteString() would
+  // fail for rewrite, then ok() is false and error() says why.
+  RewriteTemplate(const RE2& re, absl::string_view rewrite);
+
+  bool ok() const { return error_.empty(); }
+  const std::string& error() const { return error_; }
+
+  // Returns the maximum submatch needed for the rewrite, as for
+  // RE2::MaxSubmatch().
+  int max_submatch() const { return max_submatch_; }
+
+  // Appends the rewrite to *out, substituting vec[n] for each \n.
+  // REQUIRES: ok() and vec has at least max_submatch()+1 elements.
+  void Rewrite(std::string* out, const absl::string_view* vec) const;
+
+ private:
+  // The literal text of the rewrite, unescaped.
+  std::string text_;
+  // The rewrite is a sequence of pieces, each of which is the next len
+  // bytes of text_ followed by the submatch n, if n >= 0.
+  struct Piece {
+    size_t len;
+    int n;
+  };
+  std::vector<Piece> pieces_;
+  int max_submatch_;
+  std::string error_;
+};
+
+// RE2::FindAll goes through the successive non-overlapping matches of a
+// regexp in some text, just as GlobalReplace() does (so an empty match
+// right where the previous match ended is passed over), storing each in
+// turn in the caller's submatch[0, nsubmatch) as Match() would.  E.g.
+//
+//    absl::string_view sub[3];
+//    RE2::FindAll all(text, re, sub, 3);
+//    while (all.Next()) {
+//      ... sub[0] is the match, sub[1] and sub[2] the first two groups ...
+//    }
+//
+// or, equivalently, using a range-based for loop, which yields sub:
+//
+//    for (const absl::string_view* m : RE2::FindAll(text, re, sub, 3)) {
+//      ... m[0] is the match, m[1] and m[2] the first two groups ...
+//    }
+//
+// Nothing is allocated.  As with Match(), asking for fewer submatches
+// makes it faster, and with few enough, the matches are found a batch at
+// a time, so that the cost of each one is little more than that of the
+// DFA scan over the text.
+//
+// A FindAll must not outlive text, re or submatch, and can be used by
+// only one thread at a time.
+class RE2::FindAll {
+ public:
+  // REQUIRES: nsubmatch >= 1
+  FindAll(absl::string_view text, const RE2& re, absl::string_view* submatch,
+          int nsubmatch);
+
+  // Not copyable.
+  FindAll(const FindAll&) = delete;
+  FindAll& operator=(const FindAll&) = delete;
+
+  // Finds the next match and fills in submatch[0, nsubmatch).  Returns
+  // false if there are no more matches, in which case submatch[] may
+  // have been clobbered.
+  bool Next();
+
+  // An input iterator whose value is submatch after each call to Next().
+  class iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = const absl::string_view*;
+    using difference_type = ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    const absl::string_view* operator*() const { return all_->submatch_; }
+    iterator& operator++() {
+      if (!all_->Next())
+        all_ = NULL;
+      return *this;
+    }
+    bool operator==(const iterator& other) const { return all_ == other.all_; }
+    bool operator!=(const iterator& other) const { return all_ != other.all_; }
+
+   private:
+    friend class FindAll;
+    explicit iterator(FindAll* all) : all_(all) {}
+    FindAll* all_;  // NULL at the end
+  };
+
+  // Calls Next() to find the first match, so can be called only once.
+  iterator begin() { return ++iterator(this); }
+  iterator end() { return iterator(NULL); }
+
+ private:
+  // Room for the batch of matches found by RE2::MatchSuccessive().
+  static constexpr int kBatchSize = 64;
+
+  absl::string_view text_;
+  const RE2* re_;
+  absl::string_view* submatch_;
+  int nsubmatch_;
+  const char* p_;          // where to search from next
+  const char* lastend_;    // where the last match ended, or NULL
+  int nbatch_;             // number of matches in batch_
+  int next_;               // index in batch_ of the next match to use
+  int want_;               // number of matches to ask for next time
+  bool last_;              // whether batch_ has the last of the matches
+  bool successive_;        // whether to use RE2::MatchSuccessive()
+  absl::string_view batch_[kBatchSize];
+};
+
 template <typename T>
 inline RE2::Arg RE2::CRadix(T* ptr) {
   return RE2::Arg(ptr, [](const char* str, size_t n, void* dest) -> bool {
@@ -13,6 +13,7 @@
 #include <string.h>
 #include <cctype>
 #include <algorithm>
+#include <limits>
 #include <map>
 #include <string>
 #include <vector>
@@ -711,6 +712,155 @@ std::map<int, std::string>* Regexp::CaptureNames() {
   return w.TakeMap();
 }
 
+// The least and the greatest number of bytes that a regexp can match,
+// with max being -1 if there is no limit.
+struct ByteLengths {
+  int64_t min;
+  int64_t max;
+};
+
+// Walker subclass to compute the range of lengths of matches of a regexp.
+class ByteLengthWalker : public Regexp::Walker<ByteLengths> {
+ public:
+  ByteLengthWalker() {}
+
+  virtual ByteLengths PostVisit(Regexp* re, ByteLengths parent_arg,
+                                ByteLengths pre_arg,
+                                ByteLengths* child_args, int nchild_args);
+
+  virtual ByteLengths ShortVisit(Regexp* re, ByteLengths parent_arg) {
+    // Should never be called: we use Walk(), not WalkExponential().
+#ifndef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+    ABSL_LOG(DFATAL) << "ByteLengthWalker::ShortVisit called";
+#endif
+    return {0, -1};
+  }
+
+ private:
+  ByteLengthWalker(const ByteLengthWalker&) = delete;
+  ByteLengthWalker& operator=(const ByteLengthWalker&) = delete;
+};
+
+// Returns the number of bytes that r takes up in the regexp's encoding.
+static int64_t RuneBytes(Rune r, bool latin1) {
+  if (latin1)
+    return 1;
+  return runelen(r);
+}
+
+ByteLengths ByteLengthWalker::PostVisit(Regexp* re, ByteLengths parent_arg,
+                                        ByteLengths pre_arg,
+                                        ByteLengths* child_args,
+                                        int nchild_args) {
+  bool latin1 = (re->parse_flags() & Regexp::Latin1) != 0;
+  ByteLengths len = {0, 0};
+  switch (re->op()) {
+    case kRegexpNoMatch:
+    case kRegexpEmptyMatch:
+    case kRegexpBeginLine:
+    case kRegexpEndLine:
+    case kRegexpBeginText:
+    case kRegexpEndText:
+    case kRegexpWordBoundary:
+    case kRegexpNoWordBoundary:
+    case kRegexpHaveMatch:
+      break;
+
+    case kRegexpLiteral:
+      // A case-folded literal is an ASCII letter, so either case will do.
+      len.min = len.max = RuneBytes(re->rune(), latin1);
+      break;
+
+    case kRegexpLiteralString:
+      for (int i = 0; i < re->nrunes(); i++)
+        len.min += RuneBytes(re->runes()[i], latin1);
+      len.max = len.min;
+      break;
+
+    case kRegexpAnyChar:
+      len.min = 1;
+      len.max = latin1 ? 1 : UTFmax;
+      break;
+
+    case kRegexpAnyByte:
+      len.min = len.max = 1;
+      break;
+
+    case kRegexpCharClass: {
+      // The encoded length only grows with the rune.
+      CharClass* cc = re->cc();
+      if (!cc->empty()) {
+        len.min = RuneBytes(cc->begin()->lo, latin1);
+        len.max = RuneBytes((cc->end()-1)->hi, latin1);
+      }
+      break;
+    }
+
+    case kRegexpConcat:
+      for (int i = 0; i < nchild_args; i++) {
+        len.min += child_args[i].min;
+        if (len.max < 0 || child_args[i].max < 0)
+          len.max = -1;
+        else
+          len.max += child_args[i].max;
+      }
+      break;
+
+    case kRegexpAlternate:
+      len = child_args[0];
+      for (int i = 1; i < nchild_args; i++) {
+        len.min = std::min(len.min, child_args[i].min);
+        if (len.max < 0 || child_args[i].max < 0)
+          len.max = -1;
+        else
+          len.max = std::max(len.max, child_args[i].max);
+      }
+      break;
+
+    case kRegexpStar:
+    case kRegexpPlus:
+    case kRegexpQuest:
+    case kRegexpRepeat: {
+      int min = 0;
+      int max = -1;
+      if (re->op() == kRegexpPlus) {
+        min = 1;
+      } else if (re->op() == kRegexpQuest) {
+        max = 1;
+      } else if (re->op() == kRegexpRepeat) {
+        min = re->min();
+        max = re->max();
+      }
+      len.min = min * child_args[0].min;
+      if (child_args[0].max == 0 || max == 0)
+        len.max = 0;
+      else if (child_args[0].max < 0 || max < 0)
+        len.max = -1;
+      else
+        len.max = max * child_args[0].max;
+      break;
+    }
+
+    case kRegexpCapture:
+      len = child_args[0];
+      break;
+  }
+
+  // Counts this large are not worth being exact about.
+  const int64_t kMaxLength = std::numeric_limits<int>::max();
+  len.min = std::min(len.min, kMaxLength);
+  if (len.max > kMaxLength)
+    len.max = -1;
+  return len;
+}
+
+void Regexp::ByteLengthRange(int* min, int* max) {
+  ByteLengthWalker w;
+  ByteLengths len = w.Walk(this, {0, -1});
+  *min = static_cast<int>(len.min);
+  *max = static_cast<int>(len.max);
+}
+
 void ConvertRunesToBytes(bool latin1, Rune* runes, int nrunes,
                          std::string* bytes) {
   if (latin1) {
@@ -797,6 +947,171 @@ bool Regexp::RequiredPrefixForAccel(std::string* prefix, bool* foldcase) {
   return true;
 }
 
+// Determines whether regexp is nothing more than a literal char
+// or string.  If so, returns the literal.
+// The literal might be ASCII case-insensitive.
+bool Regexp::IsLiteralString(std::string* literal, bool* foldcase) {
+  literal->clear();
+  *foldcase = false;
+
+  // No need for a walker: the regexp must be a literal char or string.
+  if (op_ != kRegexpLiteral &&
+      op_ != kRegexpLiteralString)
+    return false;
+
+  bool latin1 = (parse_flags() & Latin1) != 0;
+  Rune* runes = op_ == kRegexpLiteral ? &rune_ : runes_;
+  int nrunes = op_ == kRegexpLiteral ? 1 : nrunes_;
+  ConvertRunesToBytes(latin1, runes, nrunes, literal);
+  *foldcase = (parse_flags() & FoldCase) != 0;
+  return true;
+}
+
+// Maximum number of literals that RequiredInnerLiterals() returns.
+static const size_t kMaxInnerLiterals = 16;
+
+// Computes the set of strings that re matches, provided that they are
+// nonempty, case-sensitive and there are at most kMaxInnerLiterals of them.
+static bool LiteralSet(Regexp* re, std::vector<std::string>* set) {
+  set->clear();
+  bool latin1 = (re->parse_flags() & Regexp::Latin1) != 0;
+  switch (re->op()) {
+    default:
+      return false;
+
+    case kRegexpLiteral:
+    case kRegexpLiteralString: {
+      if (re->parse_flags() & Regexp::FoldCase)
+        return false;
+      std::string lit;
+      if (re->op() == kRegexpLiteral) {
+        Rune r = re->rune();
+        ConvertRunesToBytes(latin1, &r, 1, &lit);
+      } else {
+        ConvertRunesToBytes(latin1, re->runes(), re->nrunes(), &lit);
+      }
+      set->push_back(std::move(lit));
+      return true;
+    }
+
+    case kRegexpCharClass: {
+      CharClass* cc = re->cc();
+      if (cc->size() < 1 || static_cast<size_t>(cc->size()) > kMaxInnerLiterals)
+        return false;
+      for (CharClass::iterator i = cc->begin(); i != cc->end(); ++i) {
+        for (Rune r = i->lo; r <= i->hi; r++) {
+          std::string lit;
+          ConvertRunesToBytes(latin1, &r, 1, &lit);
+          set->push_back(std::move(lit));
+        }
+      }
+      return true;
+    }
+
+    case kRegexpCapture:
+      return LiteralSet(re->sub()[0], set);
+
+    case kRegexpAlternate: {
+      std::vector<std::string> subset;
+      for (int i = 0; i < re->nsub(); i++) {
+        if (!LiteralSet(re->sub()[i], &subset) ||
+            set->size() + subset.size() > kMaxInnerLiterals)
+          return false;
+        set->insert(set->end(), subset.begin(), subset.end());
+      }
+      return true;
+    }
+
+    case kRegexpConcat: {
+      std::vector<std::string> subset;
+      std::vector<std::string> product;
+      set->push_back(std::string());
+      for (int i = 0; i < re->nsub(); i++) {
+        if (!LiteralSet(re->sub()[i], &subset) ||
+            set->size() * subset.size() > kMaxInnerLiterals)
+          return false;
+        product.clear();
+        for (const std::string& a : *set)
+          for (const std::string& b : subset)
+            product.push_back(a + b);
+        set->swap(product);
+      }
+      return true;
+    }
+  }
+}
+
+// Determines whether regexp is a concatenation that requires one of
+// a small set of case-sensitive literals after its first element.
+// If so, returns the literals and the part before them.
+bool Regexp::RequiredInnerLiterals(std::vector<std::string>* literals,
+                                   Regexp** prefix) {
+  literals->clear();
+  *prefix = NULL;
+
+  // No need for a walker: we look only at the elements of the
+  // concatenation.  We "see through" capturing groups around it.
+  Regexp* re = this;
+  while (re->op_ == kRegexpCapture)
+    re = re->sub()[0];
+  if (re->op_ != kRegexpConcat)
+    return false;
+
+  // Prefer whichever candidate has the longest shortest literal:
+  // any single literal in the concatenation or the set of strings
+  // matched by the last few elements.
+  int best = -1;
+  size_t bestlen = 0;
+  std::vector<std::string> set;
+  for (int i = 1; i < re->nsub_; i++) {
+    Regexp* sub = re->sub()[i];
+    if ((sub->op_ == kRegexpLiteral || sub->op_ == kRegexpLiteralString) &&
+        LiteralSet(sub, &set) && set[0].size() > bestlen) {
+      best = i;
+      bestlen = set[0].size();
+      literals->swap(set);
+    }
+  }
+  std::vector<std::string> suffix(1);
+  std::vector<std::string> product;
+  for (int i = re->nsub_ - 1; i >= 1; i--) {
+    if (!LiteralSet(re->sub()[i], &set) ||
+        set.size() * suffix.size() > kMaxInnerLiterals)
+      break;
+    product.clear();
+    size_t minlen = std::string::npos;
+    for (const std::string& a : set) {
+      for (const std::string& b : suffix) {
+        product.push_back(a + b);
+        minlen = std::min(minlen, product.back().size());
+      }
+    }
+    suffix.swap(product);
+    if (minlen > bestlen) {
+      best = i;
+      bestlen = minlen;
+      *literals = suffix;
+    }
+  }
+  if (best < 0) {
+    literals->clear();
+    return false;
+  }
+
+  // Remove duplicates, which would just be searched for twice.
+  std::sort(literals->begin(), literals->end());
+  literals->erase(std::unique(literals->begin(), literals->end()),
+                  literals->end());
+
+  for (int i = 0; i < best; i++)
+    re->sub()[i]->Incref();
+  if (best == 1)
+    *prefix = re->sub()[0];
+  else
+    *prefix = Concat(re->sub(), best, re->parse_flags());
+  return true;
+}
+
 // Character class builder is a balanced binary tree (STL set)
 // containing non-overlapping, non-abutting RuneRanges.
 // The less-than operator used in the tree treats two
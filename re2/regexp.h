@@ -92,6 +92,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
@@ -383,6 +384,18 @@ class Regexp {
   static Regexp* Parse(absl::string_view s, ParseFlags flags,
                        RegexpStatus* status);
 
+  // Returns a regular expression that matches any one of words, like the
+  // one that Parse() returns for the words joined with | with Literal
+  // among the flags, but without going through the parser: the words are
+  // laid out as a trie, which makes for a much smaller program.  For
+  // leftmost-first matching, the trie still prefers the earlier of two
+  // words when one is a prefix of the other.
+  // Caller must release return value with re->Decref().
+  // On failure, sets *status (if status != NULL) and returns NULL.
+  static Regexp* ParseWords(const std::vector<std::string>& words,
+                            bool longest_match, ParseFlags flags,
+                            RegexpStatus* status);
+
   // Returns a _new_ simplified version of the current regexp.
   // Does not edit the current regexp.
   // Caller must release return value with re->Decref().
@@ -404,6 +417,12 @@ class Regexp {
   int NumCaptures();
   friend class NumCapturesWalker;
 
+  // Sets *min and *max to the least and the greatest number of bytes
+  // that a match of the regexp can span, with *max set to -1 if there
+  // is no limit.  Unlike the program, this doesn't expand x{n,m}, so it
+  // is cheap even for large counts.
+  void ByteLengthRange(int* min, int* max);
+
   // Returns a map from names to capturing group indices,
   // or NULL if the regexp contains no named capture groups.
   // The caller is responsible for deleting the map.
@@ -451,6 +470,14 @@ class Regexp {
   Prog* CompileToProg(int64_t max_mem);
   Prog* CompileToReverseProg(int64_t max_mem);
 
+  // Like CompileToProg(), but the only groups that capture are those for
+  // which cap_map[cap] > 0, and they capture as group cap_map[cap] instead.
+  // cap_map must have an entry for every group, plus one (unused) for the
+  // whole match.  With fewer groups to keep track of, the engines that find
+  // submatches have less work to do.
+  Prog* CompileToProgWithCaptures(const std::vector<int>& cap_map,
+                                  int64_t max_mem);
+
   // Whether to expect this library to find exactly the same answer as PCRE
   // when running this regexp.  Most regexps do mimic PCRE exactly, but a few
   // obscure cases behave differently.  Technically this is more a property
@@ -477,6 +504,25 @@ class Regexp {
   // regardless of the return value.
   bool RequiredPrefixForAccel(std::string* prefix, bool* foldcase);
 
+  // Whether this regexp is a literal char or string (perhaps after
+  // ASCII case-folding), in which case every match is an occurrence
+  // of the literal.  If so, returns the literal.
+  // Callers should expect *literal and *foldcase to be "zeroed"
+  // regardless of the return value.
+  bool IsLiteralString(std::string* literal, bool* foldcase);
+
+  // Whether this regexp is a concatenation such that every match must
+  // contain, after whatever the first element matches, one of a small
+  // set of case-sensitive literals: either a literal char or string in
+  // the concatenation or one of the strings that its last few elements
+  // match (e.g. "\\.(exe|dll)").  If so, returns the literals and, in
+  // *prefix, the concatenation of the elements before them.  The caller
+  // must Decref() *prefix.
+  // Callers should expect *literals and *prefix to be "zeroed"
+  // regardless of the return value.
+  bool RequiredInnerLiterals(std::vector<std::string>* literals,
+                             Regexp** prefix);
+
   // Controls the maximum repeat count permitted by the parser.
   // FOR FUZZING ONLY.
   static void FUZZING_ONLY_set_maximum_repeat_count(int i);
@@ -0,0 +1,230 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re2/replace_set.h"
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_log.h"
+#include "absl/strings/string_view.h"
+#include "re2/prog.h"
+#include "re2/re2.h"
+#include "re2/set.h"
+#include "re2/sparse_set.h"
+
+namespace re2 {
+
+// Returns pattern followed by whatever it takes to end a \Q...\E quote
+// that it leaves open, so that more can be appended to it.
+static std::string CloseQuote(absl::string_view pattern) {
+  bool quoted = false;
+  for (size_t i = 0; i + 1 < pattern.size(); i++) {
+    if (pattern[i] != '\\')
+      continue;
+    if (quoted) {
+      // Only \E means anything here.
+      if (pattern[i+1] == 'E') {
+        quoted = false;
+        i++;
+      }
+      continue;
+    }
+    if (pattern[i+1] == 'Q')
+      quoted = true;
+    i++;
+  }
+  std::string s(pattern);
+  if (quoted)
+    s += "\\E";
+  return s;
+}
+
+// Returns whether prog uses \b or \B anywhere.
+static bool UsesWordBoundary(Prog* prog) {
+  if (prog->inst_count(kInstEmptyWidth) == 0)
+    return false;
+  for (int id = 0; id < prog->size(); id++) {
+    Prog::Inst* ip = prog->inst(id);
+    if (ip->opcode() == kInstEmptyWidth &&
+        (ip->empty() & (kEmptyWordBoundary | kEmptyNonWordBoundary)) != 0)
+      return true;
+  }
+  return false;
+}
+
+RE2::ReplaceSet::ReplaceSet(const RE2::Options& options)
+    : options_(options),
+      compiled_(false) {
+}
+
+RE2::ReplaceSet::~ReplaceSet() = default;
+
+int RE2::ReplaceSet::Add(absl::string_view pattern, absl::string_view rewrite,
+                         std::string* error) {
+  if (compiled_) {
+    ABSL_LOG(DFATAL) << "RE2::ReplaceSet::Add() called after compiling";
+    return -1;
+  }
+
+  std::unique_ptr<RE2> re(new RE2(pattern, options_));
+  if (!re->ok()) {
+    if (error != NULL)
+      *error = re->error();
+    return -1;
+  }
+  RewriteTemplate t(*re, rewrite);
+  if (!t.ok()) {
+    if (options_.log_errors())
+      ABSL_LOG(ERROR) << "Error in rewrite '" << rewrite << "' for '"
+                      << pattern << "': " << t.error();
+    if (error != NULL)
+      *error = t.error();
+    return -1;
+  }
+
+  // The regexps are joined as (p0)|(p1)|...; plain parentheses work with
+  // any syntax, and the groups don't capture because all_ doesn't need to.
+  if (!re_.empty())
+    pattern_ += '|';
+  pattern_ += '(';
+  if (options_.literal())
+    pattern_ += QuoteMeta(pattern);
+  else
+    pattern_ += CloseQuote(pattern);
+  pattern_ += ')';
+
+  int n = static_cast<int>(re_.size());
+  re_.push_back(std::move(re));
+  rewrite_.push_back(std::move(t));
+  return n;
+}
+
+bool RE2::ReplaceSet::Compile() {
+  if (compiled_) {
+    ABSL_LOG(DFATAL) << "RE2::ReplaceSet::Compile() called more than once";
+    return false;
+  }
+  compiled_ = true;
+  if (re_.empty())
+    return true;
+
+  RE2::Options options(options_);
+  options.set_literal(false);
+  options.set_never_capture(true);
+  all_.reset(new RE2(pattern_, options));
+  if (!all_->ok()) {
+    all_.reset();
+    return false;
+  }
+
+  // An RE2::Set of the regexps, anchored at both ends, because the question
+  // is which of them match exactly what all_ matched.  A set program can't
+  // see the text around that, so it takes ^ and $ to match at both ends,
+  // which is harmless, and it can't tell whether \b or \B match there,
+  // which is not; regexps using those are always checked.
+  RE2::Set set(options_, RE2::ANCHOR_BOTH);
+  for (size_t i = 0; i < re_.size(); i++) {
+    if (set.Add(re_[i]->pattern(), NULL) < 0)
+      return false;
+    if (UsesWordBoundary(re_[i]->prog_))
+      always_.push_back(static_cast<int>(i));
+  }
+  if (!set.Compile())
+    return false;
+  prog_ = std::move(set.prog_);
+  return true;
+}
+
+bool RE2::ReplaceSet::Rewrite(std::string* out, absl::string_view text,
+                              absl::string_view match,
+                              SparseSet* matches) const {
+  // Which of the regexps could have matched?  prog_ says which of them
+  // match all of match when taken out of context, to which must be added
+  // those whose matches depend on context.  If the DFA runs out of memory,
+  // it just has to be all of them.
+  int size = static_cast<int>(re_.size());
+  bool dfa_failed = false;
+  matches->clear();
+  prog_->SearchDFA(match, match, Prog::kAnchored, Prog::kManyMatch, NULL,
+                   &dfa_failed, matches);
+  if (dfa_failed) {
+    for (int i = 0; i < size; i++)
+      matches->insert(i);
+  } else {
+    for (int i : always_)
+      matches->insert(i);
+  }
+
+  // The one added first wins.
+  size_t startpos = static_cast<size_t>(match.data() - text.data());
+  size_t endpos = startpos + match.size();
+  absl::string_view vec[10];
+  for (int last = -1;;) {
+    int i = size;
+    for (int j : *matches) {
+      if (j > last && j < i)
+        i = j;
+    }
+    if (i == size)
+      break;
+    last = i;
+    const RewriteTemplate& rewrite = rewrite_[i];
+    if (re_[i]->Match(text, startpos, endpos, RE2::ANCHOR_BOTH, vec,
+                      1 + rewrite.max_submatch())) {
+      rewrite.Rewrite(out, vec);
+      return true;
+    }
+  }
+
+  ABSL_LOG(DFATAL) << "RE2::ReplaceSet inconsistency";
+  out->append(match.data(), match.size());
+  return false;
+}
+
+int RE2::ReplaceSet::GlobalReplace(std::string* str) const {
+  if (!compiled_) {
+    ABSL_LOG(DFATAL) << "RE2::ReplaceSet::GlobalReplace() called "
+                     << "before compiling";
+    return 0;
+  }
+  if (all_ == nullptr)
+    return 0;
+
+  // *str is overwritten as it goes, but never where text is still needed.
+  absl::string_view text(*str);
+  SparseSet matches(static_cast<int>(re_.size()));
+  return RE2::GlobalReplaceWith(
+      str, *all_, 1, [&](std::string* out, const absl::string_view* vec) {
+        return Rewrite(out, text, vec[0], &matches);
+      });
+}
+
+int RE2::ReplaceSet::GlobalReplace(absl::string_view text,
+                                   const RE2::ReplaceSink& sink) const {
+  if (!compiled_) {
+    ABSL_LOG(DFATAL) << "RE2::ReplaceSet::GlobalReplace() called "
+                     << "before compiling";
+    return 0;
+  }
+  if (all_ == nullptr) {
+    if (!text.empty())
+      sink(text);
+    return 0;
+  }
+
+  SparseSet matches(static_cast<int>(re_.size()));
+  return RE2::GlobalReplaceWith(
+      text, *all_, 1,
+      [&](std::string* out, const absl::string_view* vec) {
+        return Rewrite(out, text, vec[0], &matches);
+      },
+      sink);
+}
+
+}  // namespace re2
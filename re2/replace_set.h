@@ -0,0 +1,88 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef RE2_REPLACE_SET_H_
+#define RE2_REPLACE_SET_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "re2/re2.h"
+
+namespace re2 {
+class Prog;
+template <typename Value> class SparseSetT;
+typedef SparseSetT<void> SparseSet;
+}  // namespace re2
+
+namespace re2 {
+
+// An RE2::ReplaceSet replaces the matches of many regexps, each with its
+// own rewrite, in a single pass over the text.  Calling GlobalReplace()
+// for each regexp in turn scans the text once per regexp, whereas this
+// scans it once for all of them, much as for their alternation, and then
+// replaces each match using the rewrite for the regexp that matched.
+// Where more than one of them could match at the same place, the one that
+// was added first wins, just as the leftmost alternative would.
+//
+//   RE2::ReplaceSet redact(RE2::Quiet);
+//   redact.Add("AKIA[0-9A-Z]{16}", "<aws key>", NULL);
+//   redact.Add("(\\w+)@example\\.com", "\\1@<redacted>", NULL);
+//   ABSL_CHECK(redact.Compile());
+//   redact.GlobalReplace(&document);
+//
+// Once compiled, a ReplaceSet can be used from many threads at once.
+class RE2::ReplaceSet {
+ public:
+  explicit ReplaceSet(const RE2::Options& options);
+  ~ReplaceSet();
+
+  // Not copyable.
+  ReplaceSet(const ReplaceSet&) = delete;
+  ReplaceSet& operator=(const ReplaceSet&) = delete;
+
+  // Adds pattern, whose matches are to be replaced with rewrite, using the
+  // options passed to the constructor.  Returns the index of the regexp,
+  // or -1 if the regexp cannot be parsed or the rewrite is unsuitable for
+  // it, in which case *error (if error is not NULL) says why.
+  // Indices are assigned in sequential order starting from 0.
+  int Add(absl::string_view pattern, absl::string_view rewrite,
+          std::string* error);
+
+  // Compiles the set in preparation for replacing.
+  // Returns false if the compiler runs out of memory.
+  // Add() must not be called again after Compile().
+  // Compile() must be called before GlobalReplace().
+  bool Compile();
+
+  // Like RE2::GlobalReplace(), but for all of the regexps at once.
+  // Returns the number of replacements made.
+  int GlobalReplace(std::string* str) const;
+
+  // Likewise, but passes the result to sink; see RE2::GlobalReplace().
+  // Returns the number of replacements made.
+  int GlobalReplace(absl::string_view text,
+                    const RE2::ReplaceSink& sink) const;
+
+ private:
+  // Appends the rewrite of match, which is in text, to out using the
+  // rewrite for the first regexp that matches it.
+  bool Rewrite(std::string* out, absl::string_view text,
+               absl::string_view match, SparseSet* matches) const;
+
+  RE2::Options options_;
+  std::vector<std::unique_ptr<RE2>> re_;
+  std::vector<RE2::RewriteTemplate> rewrite_;
+  std::string pattern_;        // the alternation of all of the regexps
+  bool compiled_;
+  std::unique_ptr<RE2> all_;   // compiled from pattern_
+  std::unique_ptr<re2::Prog> prog_;  // says which regexps match a match
+  std::vector<int> always_;    // regexps that prog_ can't rule out
+};
+
+}  // namespace re2
+
+#endif  // RE2_REPLACE_SET_H_
@@ -90,6 +90,54 @@ int RE2::Set::Add(absl::string_view pattern, std::string* error) {
       ABSL_LOG(ERROR) << "Error parsing '" << pattern << "': " << status.Text();
     return -1;
   }
+  return AddParsed(pattern, re);
+}
+
+void RE2::Set::AddAll(const std::vector<absl::string_view>& patterns,
+                      const RE2::ParallelFor& parallel_for,
+                      std::vector<int>* indices,
+                      std::vector<std::string>* errors) {
+  int npatterns = static_cast<int>(patterns.size());
+  if (indices != NULL)
+    indices->assign(npatterns, -1);
+  if (errors != NULL)
+    errors->assign(npatterns, std::string());
+  if (compiled_) {
+    ABSL_LOG(DFATAL) << "RE2::Set::AddAll() called after compiling";
+    return;
+  }
+
+  // Parsing is where the time goes, so do that in parallel.
+  Regexp::ParseFlags pf = static_cast<Regexp::ParseFlags>(
+    options_.ParseFlags());
+  std::vector<re2::Regexp*> res(npatterns);
+  std::vector<std::string> texts(npatterns);
+  parallel_for(npatterns, [&](int i) {
+    RegexpStatus status;
+    res[i] = Regexp::Parse(patterns[i], pf, &status);
+    if (res[i] == NULL)
+      texts[i] = status.Text();
+  });
+
+  // Then assign the indices in order, just as Add() would.
+  for (int i = 0; i < npatterns; i++) {
+    if (res[i] == NULL) {
+      if (options_.log_errors())
+        ABSL_LOG(ERROR) << "Error parsing '" << patterns[i] << "': "
+                        << texts[i];
+      if (errors != NULL)
+        (*errors)[i] = std::move(texts[i]);
+      continue;
+    }
+    int n = AddParsed(patterns[i], res[i]);
+    if (indices != NULL)
+      (*indices)[i] = n;
+  }
+}
+
+int RE2::Set::AddParsed(absl::string_view pattern, re2::Regexp* re) {
+  Regexp::ParseFlags pf = static_cast<Regexp::ParseFlags>(
+    options_.ParseFlags());
 
   // Concatenate with match index and push on vector.
   int n = static_cast<int>(elem_.size());
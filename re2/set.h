@@ -53,6 +53,15 @@ class RE2::Set {
   // the error message from the parser.
   int Add(absl::string_view pattern, std::string* error);
 
+  // Adds patterns to the set as if by calling Add() on each of them in turn,
+  // but parses them by way of parallel_for.  Fills indices (if not NULL) with
+  // what Add() would have returned for each of them and errors (if not NULL)
+  // with the error messages from the parser, which are empty on success.
+  void AddAll(const std::vector<absl::string_view>& patterns,
+              const RE2::ParallelFor& parallel_for,
+              std::vector<int>* indices,
+              std::vector<std::string>* errors);
+
   // Compiles the set in preparation for matching.
   // Returns false if the compiler runs out of memory.
   // Add() must not be called again after Compile().
@@ -73,6 +82,14 @@ class RE2::Set {
  private:
   typedef std::pair<std::string, re2::Regexp*> Elem;
 
+  // Adds the regexp parsed from pattern, taking ownership of it.
+  // Returns its index.
+  int AddParsed(absl::string_view pattern, re2::Regexp* re);
+
+  // These compile their regexps by way of a Set and then take its program.
+  friend class RE2::Lexer;
+  friend class RE2::ReplaceSet;
+
   RE2::Options options_;
   RE2::Anchor anchor_;
   std::vector<Elem> elem_;
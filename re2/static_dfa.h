@@ -0,0 +1,77 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef RE2_STATIC_DFA_H_
+#define RE2_STATIC_DFA_H_
+
+// A StaticDFA is the entire DFA for a pattern that is known when the
+// program is built, generated into C++ source by make_static_dfa:
+//
+//    make_static_dfa --output=hostname_dfa.h HostnameDFA '[a-z0-9.]+'
+//
+// The generated header defines an inline function that returns the
+// StaticDFA, whose tables are constant-initialized, so there is nothing
+// to compile or lock at run time and nothing is allocated:
+//
+//    #include "hostname_dfa.h"
+//
+//    if (HostnameDFA().Match(text)) { ... }
+//
+// Match() answers the same question as RE2::PartialMatch(text, re) with
+// no arguments -- or RE2::FullMatch(text, re) if the DFA was generated
+// with --full_match -- and it does so with one table lookup per byte.
+// It can't report submatches or even where the match is; use RE2 for that.
+//
+// A StaticDFA can have many more states than RE2 would ever build for
+// the texts that it actually sees, so it is best kept for small patterns
+// on hot paths.  make_static_dfa fails if the DFA exceeds --max_mem.
+//
+// CMake users can run make_static_dfa as part of the build by way of the
+// re2_static_dfa() function, which RE2 provides (and installs, along with
+// make_static_dfa) when configured with RE2_BUILD_TOOLS=ON.
+
+#include <stdint.h>
+
+#include "absl/strings/string_view.h"
+
+namespace re2 {
+
+class StaticDFA {
+ public:
+  // The tables are as generated by make_static_dfa.  bytemap maps each
+  // byte to its class in [0, nbytes-1); next holds nbytes slots for each
+  // state, the last one for end of text, giving the next state or -1 for
+  // the dead state; match says whether reaching the state means that the
+  // pattern has matched.  State 0 is the start state.
+  constexpr StaticDFA(const uint8_t* bytemap, int nbytes, const int32_t* next,
+                      const bool* match)
+      : bytemap_(bytemap), nbytes_(nbytes), next_(next), match_(match) {}
+
+  // Returns whether the pattern matches text.
+  bool Match(absl::string_view text) const {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(text.data());
+    const uint8_t* ep = p + text.size();
+    int32_t s = 0;
+    for (; p < ep; p++) {
+      s = next_[s*nbytes_ + bytemap_[*p]];
+      if (s < 0)
+        return false;
+      // Matches are seen one byte late, so this match ended before *p.
+      if (match_[s])
+        return true;
+    }
+    s = next_[s*nbytes_ + nbytes_-1];
+    return s >= 0 && match_[s];
+  }
+
+ private:
+  const uint8_t* bytemap_;
+  int nbytes_;
+  const int32_t* next_;
+  const bool* match_;
+};
+
+}  // namespace re2
+
+#endif  // RE2_STATIC_DFA_H_
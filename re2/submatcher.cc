@@ -0,0 +1,93 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re2/submatcher.h"
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "absl/container/fixed_array.h"
+#include "absl/log/absl_log.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "re2/prog.h"
+#include "re2/re2.h"
+#include "re2/regexp.h"
+
+namespace re2 {
+
+RE2::Submatcher::Submatcher(const RE2& re, absl::Span<const int> groups)
+    : re_(re),
+      nslot_(1),
+      is_one_pass_(false) {
+  // Number the wanted groups 1, 2, ... in the order first seen.
+  int ngroup = re_.NumberOfCapturingGroups();
+  std::vector<int> cap_map(ngroup >= 0 ? 1 + ngroup : 0, 0);
+  slot_.reserve(groups.size());
+  for (int group : groups) {
+    if (group == 0) {
+      slot_.push_back(0);
+    } else if (group > 0 && group <= ngroup) {
+      if (cap_map[group] == 0)
+        cap_map[group] = nslot_++;
+      slot_.push_back(cap_map[group]);
+    } else {
+      slot_.push_back(-1);
+    }
+  }
+
+  if (!re_.ok() || nslot_ == 1)
+    return;
+  prog_.reset(re_.Regexp()->CompileToProgWithCaptures(
+      cap_map, re_.options().max_mem()*2/3));
+  if (prog_ == nullptr) {
+    if (re_.options().log_errors())
+      ABSL_LOG(ERROR) << "Error compiling submatcher for '"
+                      << re_.pattern() << "'";
+    return;
+  }
+  is_one_pass_ = prog_->IsOnePass();
+}
+
+RE2::Submatcher::~Submatcher() = default;
+
+bool RE2::Submatcher::Match(absl::string_view text, size_t startpos,
+                            size_t endpos, Anchor re_anchor,
+                            absl::string_view* submatch) const {
+  // The RE2 finds where the match is, so the program has only to find
+  // where the groups are within it.
+  absl::string_view match;
+  if (!re_.Match(text, startpos, endpos, re_anchor, &match, 1))
+    return false;
+
+  absl::FixedArray<absl::string_view, 8> vec(nslot_);
+  vec[0] = match;
+  if (nslot_ > 1) {
+    if (prog_ == nullptr)
+      return false;
+    bool matched;
+    if (is_one_pass_ && nslot_ <= Prog::kMaxOnePassCapture)
+      matched = prog_->SearchOnePass(match, text, Prog::kAnchored,
+                                     Prog::kFullMatch, vec.data(), nslot_);
+    else if (prog_->CanBitState() &&
+             match.size() <= prog_->bit_state_text_max_size())
+      matched = prog_->SearchBitState(match, text, Prog::kAnchored,
+                                      Prog::kFullMatch, vec.data(), nslot_);
+    else
+      matched = prog_->SearchNFA(match, text, Prog::kAnchored,
+                                 Prog::kFullMatch, vec.data(), nslot_);
+    if (!matched) {
+      if (re_.options().log_errors())
+        ABSL_LOG(ERROR) << "RE2::Submatcher inconsistency";
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < slot_.size(); i++)
+    submatch[i] = slot_[i] >= 0 ? vec[slot_[i]] : absl::string_view();
+  return true;
+}
+
+}  // namespace re2
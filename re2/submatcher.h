@@ -0,0 +1,72 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#ifndef RE2_SUBMATCHER_H_
+#define RE2_SUBMATCHER_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "re2/re2.h"
+
+namespace re2 {
+class Prog;
+}  // namespace re2
+
+namespace re2 {
+
+// An RE2::Submatcher matches an RE2 as RE2::Match() would, but works out
+// the text of only the given groups.  RE2::Match() fills in submatches in
+// order, so getting group 7 means asking for groups 1 through 6 as well,
+// and the engines that find submatches (OnePass, BitState and the NFA)
+// then keep track of all of them.  A Submatcher compiles a variant of the
+// program in which only the wanted groups capture, which is less work for
+// a regexp with many groups of which only one or two are wanted.
+//
+//   RE2 re("(\\S+) (\\S+) (\\S+) (?P<status>\\d+) (\\d+)");
+//   RE2::Submatcher status(re, {re.NamedCapturingGroups().at("status")});
+//   absl::string_view code;
+//   if (status.Match(line, 0, line.size(), RE2::UNANCHORED, &code)) {
+//     ...
+//   }
+//
+// The RE2 must outlive the Submatcher, which finds the match itself with
+// the RE2's DFAs and then only the wanted groups with its own program.
+// A Submatcher can be used from many threads at once.
+class RE2::Submatcher {
+ public:
+  // Works out the groups with the given indices.  Group 0 is the whole
+  // match.  Groups that don't exist are always empty.
+  Submatcher(const RE2& re, absl::Span<const int> groups);
+
+  ~Submatcher();
+
+  // Not copyable.
+  Submatcher(const Submatcher&) = delete;
+  Submatcher& operator=(const Submatcher&) = delete;
+
+  // Returns the number of groups that the Submatcher works out.
+  int size() const { return static_cast<int>(slot_.size()); }
+
+  // Like RE2::Match(), except that submatch[i] is set to the text of
+  // the i'th of the groups given to the constructor.  submatch must have
+  // room for size() entries.
+  bool Match(absl::string_view text, size_t startpos, size_t endpos,
+             Anchor re_anchor, absl::string_view* submatch) const;
+
+ private:
+  const RE2& re_;
+  std::vector<int> slot_;  // where each of the groups is captured, or -1
+  int nslot_;              // 1 + the number of groups that prog_ captures
+  std::unique_ptr<re2::Prog> prog_;  // captures only the wanted groups
+  bool is_one_pass_;
+};
+
+}  // namespace re2
+
+#endif  // RE2_SUBMATCHER_H_
@@ -0,0 +1,105 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re2/cache.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "re2/re2.h"
+
+namespace re2 {
+
+TEST(Cache, Shared) {
+  RE2::Cache cache(10);
+
+  std::shared_ptr<const RE2> a = cache.Get("a+b", RE2::DefaultOptions);
+  std::shared_ptr<const RE2> b = cache.Get("a+b", RE2::DefaultOptions);
+  ASSERT_TRUE(a->ok());
+  ASSERT_EQ(a.get(), b.get());
+  ASSERT_TRUE(RE2::FullMatch("aab", *a));
+
+  // Different options make for a different RE2 object.
+  std::shared_ptr<const RE2> c = cache.Get("a+b", RE2::Latin1);
+  ASSERT_NE(a.get(), c.get());
+  ASSERT_EQ(c->options().encoding(), RE2::Options::EncodingLatin1);
+  RE2::Options options;
+  options.set_max_mem(1<<20);
+  std::shared_ptr<const RE2> d = cache.Get("a+b", options);
+  ASSERT_NE(a.get(), d.get());
+  ASSERT_EQ(d->options().max_mem(), 1<<20);
+
+  RE2::Cache::Stats stats = cache.stats();
+  ASSERT_EQ(stats.hits, 1);
+  ASSERT_EQ(stats.misses, 3);
+  ASSERT_EQ(stats.evictions, 0);
+  ASSERT_EQ(stats.size, size_t{3});
+}
+
+TEST(Cache, Errors) {
+  RE2::Cache cache(10);
+
+  std::shared_ptr<const RE2> a = cache.Get("a(", RE2::Quiet);
+  ASSERT_FALSE(a->ok());
+  ASSERT_EQ(a->error_code(), RE2::ErrorMissingParen);
+  ASSERT_EQ(a.get(), cache.Get("a(", RE2::Quiet).get());
+}
+
+TEST(Cache, Eviction) {
+  RE2::Cache cache(2);
+
+  std::shared_ptr<const RE2> a = cache.Get("a", RE2::DefaultOptions);
+  std::shared_ptr<const RE2> b = cache.Get("b", RE2::DefaultOptions);
+  // Using a makes b the least recently used, so c evicts b.
+  ASSERT_EQ(a.get(), cache.Get("a", RE2::DefaultOptions).get());
+  std::shared_ptr<const RE2> c = cache.Get("c", RE2::DefaultOptions);
+  ASSERT_EQ(cache.stats().evictions, 1);
+  ASSERT_EQ(a.get(), cache.Get("a", RE2::DefaultOptions).get());
+  ASSERT_EQ(c.get(), cache.Get("c", RE2::DefaultOptions).get());
+
+  // The evicted object is still usable, but it is no longer shared.
+  ASSERT_TRUE(RE2::FullMatch("b", *b));
+  ASSERT_NE(b.get(), cache.Get("b", RE2::DefaultOptions).get());
+
+  cache.Clear();
+  ASSERT_EQ(cache.stats().size, size_t{0});
+  ASSERT_TRUE(RE2::FullMatch("a", *a));
+}
+
+TEST(Cache, Global) {
+  std::shared_ptr<const RE2> a =
+      RE2::Cache::Global()->Get("x*y", RE2::DefaultOptions);
+  ASSERT_EQ(a.get(),
+            RE2::Cache::Global()->Get("x*y", RE2::DefaultOptions).get());
+}
+
+TEST(Cache, Multithreaded) {
+  RE2::Cache cache(4);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([&cache, i]() {
+      for (int j = 0; j < 100; j++) {
+        std::string pattern = "x{" + std::to_string((i + j) % 6) + "}";
+        std::shared_ptr<const RE2> re = cache.Get(pattern, RE2::DefaultOptions);
+        ASSERT_TRUE(re->ok());
+        ASSERT_EQ(re->pattern(), pattern);
+        ASSERT_TRUE(RE2::FullMatch(std::string((i + j) % 6, 'x'), *re));
+      }
+    });
+  }
+  for (std::thread& t : threads)
+    t.join();
+
+  RE2::Cache::Stats stats = cache.stats();
+  ASSERT_EQ(stats.hits + stats.misses, 800);
+  ASSERT_LE(stats.size, size_t{4});
+}
+
+}  // namespace re2
@@ -127,6 +127,13 @@ static Test tests[] = {
     "4. byte [61-61] 0 -> 5\n"
     "5+ nop -> 3\n"
     "6. match! 0\n" },
+  // Common suffixes are merged.
+  { "abd|cbd",
+    "3+ byte [61-61] 0 -> 5\n"
+    "4. byte [63-63] 0 -> 5\n"
+    "5. byte [62-62] 0 -> 6\n"
+    "6. byte [64-64] 0 -> 7\n"
+    "7. match! 0\n" },
 };
 
 TEST(TestRegexpCompileToProg, Simple) {
@@ -340,6 +347,93 @@ TEST(TestCompile, Bug26705922) {
             reverse);
 }
 
+TEST(TestCompile, CharClassCache) {
+  // Large classes for UTF-8 are compiled once and then copied, so the
+  // fragment must come out the same wherever it lands in the program.
+
+  std::string forward, reverse;
+
+  Dump("[\\x{100}\\x{102}\\x{104}\\x{106}\\x{108}\\x{10a}\\x{10c}\\x{300}]",
+       Regexp::LikePerl, &forward, &reverse);
+  EXPECT_EQ("3+ byte [c4-c4] 0 -> 5\n"
+            "4. byte [cc-cc] 0 -> 13\n"
+            "5+ nop -> 13\n"
+            "6+ byte [82-82] 0 -> 12\n"
+            "7+ byte [84-84] 0 -> 12\n"
+            "8+ byte [86-86] 0 -> 12\n"
+            "9+ byte [88-88] 0 -> 12\n"
+            "10+ byte [8a-8a] 0 -> 12\n"
+            "11. byte [8c-8c] 0 -> 12\n"
+            "12. match! 0\n"
+            "13. byte [80-80] 0 -> 12\n",
+            forward);
+  EXPECT_EQ("3+ byte [80-80] 0 -> 10\n"
+            "4+ byte [82-82] 0 -> 13\n"
+            "5+ byte [84-84] 0 -> 13\n"
+            "6+ byte [86-86] 0 -> 13\n"
+            "7+ byte [88-88] 0 -> 13\n"
+            "8+ byte [8a-8a] 0 -> 13\n"
+            "9. byte [8c-8c] 0 -> 13\n"
+            "10+ nop -> 13\n"
+            "11. byte [cc-cc] 0 -> 12\n"
+            "12. match! 0\n"
+            "13. byte [c4-c4] 0 -> 12\n",
+            reverse);
+
+  Dump("ab[\\x{100}\\x{102}\\x{104}\\x{106}\\x{108}\\x{10a}\\x{10c}\\x{300}]",
+       Regexp::LikePerl, &forward, &reverse);
+  EXPECT_EQ("3. byte [61-61] 0 -> 4\n"
+            "4. byte [62-62] 0 -> 5\n"
+            "5+ byte [c4-c4] 0 -> 7\n"
+            "6. byte [cc-cc] 0 -> 15\n"
+            "7+ nop -> 15\n"
+            "8+ byte [82-82] 0 -> 14\n"
+            "9+ byte [84-84] 0 -> 14\n"
+            "10+ byte [86-86] 0 -> 14\n"
+            "11+ byte [88-88] 0 -> 14\n"
+            "12+ byte [8a-8a] 0 -> 14\n"
+            "13. byte [8c-8c] 0 -> 14\n"
+            "14. match! 0\n"
+            "15. byte [80-80] 0 -> 14\n",
+            forward);
+  EXPECT_EQ("3+ byte [80-80] 0 -> 10\n"
+            "4+ byte [82-82] 0 -> 15\n"
+            "5+ byte [84-84] 0 -> 15\n"
+            "6+ byte [86-86] 0 -> 15\n"
+            "7+ byte [88-88] 0 -> 15\n"
+            "8+ byte [8a-8a] 0 -> 15\n"
+            "9. byte [8c-8c] 0 -> 15\n"
+            "10+ nop -> 15\n"
+            "11. byte [cc-cc] 0 -> 12\n"
+            "12. byte [62-62] 0 -> 13\n"
+            "13. byte [61-61] 0 -> 14\n"
+            "14. match! 0\n"
+            "15. byte [c4-c4] 0 -> 12\n",
+            reverse);
+}
+
+TEST(TestCompile, ReverseCaptures) {
+  // The reverse program is only run by the DFA, so it omits captures.
+
+  std::string forward, reverse;
+
+  Dump("(a+)(b)", Regexp::PerlX|Regexp::Latin1, &forward, &reverse);
+  EXPECT_EQ("3. capture 2 -> 4\n"
+            "4. byte [61-61] 0 -> 5\n"
+            "5+ nop -> 4\n"
+            "6. capture 3 -> 7\n"
+            "7. capture 4 -> 8\n"
+            "8. byte [62-62] 0 -> 9\n"
+            "9. capture 5 -> 10\n"
+            "10. match! 0\n",
+            forward);
+  EXPECT_EQ("3. byte [62-62] 0 -> 4\n"
+            "4. byte [61-61] 0 -> 5\n"
+            "5+ nop -> 4\n"
+            "6. match! 0\n",
+            reverse);
+}
+
 TEST(TestCompile, Bug35237384) {
   // Bug in the compiler caused inefficient bytecode to be generated for
   // nested nullable subexpressions.
@@ -271,6 +271,36 @@ TEST(Multithreaded, SearchDFA) {
   ASSERT_EQ(search_failures, 0);
 }
 
+// Test that RE2 stops trying the DFA when it keeps failing.
+TEST(SingleThreaded, SkipFailingDFA) {
+  search_failures = 0;
+
+  // As above, but without the $ so that the forward DFA has to run,
+  // the De Bruijn string makes it thrash its state cache and bail out.
+  const int n = 18;
+  RE2 re(absl::StrFormat("0[01]{%d}[^01]", n));
+  ASSERT_TRUE(re.ok());
+  std::string text = DeBruijnString(n);
+
+  // Ask for the match so that RE2 can't avoid the DFA altogether.
+  for (int i = 0; i < 10; i++) {
+    absl::string_view m;
+    ASSERT_FALSE(re.Match(text, 0, text.size(), RE2::UNANCHORED, &m, 1));
+  }
+  ASSERT_EQ(search_failures, 3);
+
+  // Once in a while, the DFA gets another chance.  Here, it completes
+  // the search, so it is back in business until it fails again.
+  std::string small = std::string(n+1, '0') + "x";
+  for (int i = 0; i < 64; i++) {
+    absl::string_view m;
+    ASSERT_TRUE(re.Match(small, 0, small.size(), RE2::UNANCHORED, &m, 1));
+  }
+  absl::string_view m;
+  ASSERT_FALSE(re.Match(text, 0, text.size(), RE2::UNANCHORED, &m, 1));
+  ASSERT_EQ(search_failures, 4);
+}
+
 struct ReverseTest {
   const char* regexp;
   const char* text;
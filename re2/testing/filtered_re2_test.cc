@@ -7,12 +7,16 @@
 #include <stddef.h>
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/log/absl_log.h"
+#include "absl/strings/string_view.h"
 #include "gtest/gtest.h"
 #include "re2/re2.h"
 
@@ -340,4 +344,57 @@ TEST(FilteredRE2Test, MoveSemantics) {
   EXPECT_EQ(size_t{0}, v1.matches.size());
 }
 
+// Calls fn(i) for every i in [0, n) on a few threads.
+static void ThreadedFor(int n, const std::function<void(int i)>& fn) {
+  std::atomic<int> next(0);
+  std::vector<std::thread> threads;
+  for (int j = 0; j < 4; j++) {
+    threads.emplace_back([&]() {
+      for (int i; (i = next.fetch_add(1)) < n;)
+        fn(i);
+    });
+  }
+  for (std::thread& t : threads)
+    t.join();
+}
+
+TEST(FilteredRE2Test, AddAll) {
+  std::vector<absl::string_view> patterns = {
+      "(abc123|def456|ghi789).*mnop[x-z]+",
+      "(",
+      "abc..yyy..zz",
+      "mnmnpp[a-z]+PPP",
+  };
+
+  FilterTestVars v1;
+  v1.opts.set_log_errors(false);
+  for (absl::string_view pattern : patterns) {
+    int id;
+    v1.f.Add(pattern, v1.opts, &id);
+  }
+  v1.f.Compile(&v1.atoms);
+
+  FilterTestVars v2;
+  v2.opts.set_log_errors(false);
+  std::vector<int> ids;
+  std::vector<RE2::ErrorCode> codes;
+  v2.f.AddAll(patterns, v2.opts, ThreadedFor, &ids, &codes);
+  EXPECT_EQ(ids, std::vector<int>({0, -1, 1, 2}));
+  EXPECT_EQ(codes, std::vector<RE2::ErrorCode>({RE2::NoError,
+                                                RE2::ErrorMissingParen,
+                                                RE2::NoError,
+                                                RE2::NoError}));
+  v2.f.Compile(&v2.atoms, ThreadedFor);
+
+  // Same atoms in the same order, so the same atom ids.
+  EXPECT_EQ(v1.atoms, v2.atoms);
+  EXPECT_EQ(v2.f.NumRegexps(), 3);
+  for (size_t i = 0; i < v1.atoms.size(); i++) {
+    std::vector<int> atom_ids = {static_cast<int>(i)};
+    v1.f.AllMatches("abc123 mnopz abcxxyyyxxzz", atom_ids, &v1.matches);
+    v2.f.AllMatches("abc123 mnopz abcxxyyyxxzz", atom_ids, &v2.matches);
+    EXPECT_EQ(v1.matches, v2.matches);
+  }
+}
+
 }  //  namespace re2
@@ -0,0 +1,142 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re2/lexer.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "gtest/gtest.h"
+#include "re2/re2.h"
+
+namespace re2 {
+
+// Returns the tokens of text as (index, token) pairs, stopping at the
+// first place where none of the regexps match.
+static std::vector<std::pair<int, std::string>> Tokens(
+    const RE2::Lexer& lexer, absl::string_view text) {
+  std::vector<std::pair<int, std::string>> tokens;
+  absl::string_view token;
+  int id;
+  while (!text.empty() && (id = lexer.Consume(&text, &token, 1)) >= 0)
+    tokens.emplace_back(id, std::string(token));
+  return tokens;
+}
+
+TEST(Lexer, MaximalMunch) {
+  RE2::Lexer lexer(RE2::DefaultOptions);
+  ASSERT_EQ(lexer.Add("if|else", NULL), 0);
+  ASSERT_EQ(lexer.Add("[a-z]\\w*", NULL), 1);
+  ASSERT_EQ(lexer.Add("\\d+", NULL), 2);
+  ASSERT_EQ(lexer.Add("\\s+", NULL), 3);
+  ASSERT_EQ(lexer.Add("=|==|<|<=", NULL), 4);
+  ASSERT_EQ(lexer.Add("\\d+\\.\\d*", NULL), 5);
+  ASSERT_TRUE(lexer.Compile());
+
+  std::vector<std::pair<int, std::string>> want = {
+    {0, "if"}, {3, " "}, {1, "iffy"}, {3, " "}, {4, "<="}, {3, " "},
+    {2, "12"}, {3, " "}, {1, "else2"}, {4, "=="}, {5, "3."}, {1, "x"},
+    {4, "="}, {2, "4"},
+  };
+  ASSERT_EQ(Tokens(lexer, "if iffy <= 12 else2==3.x=4"), want);
+
+  // None of the regexps match, so nothing is consumed.
+  absl::string_view input("!if");
+  absl::string_view token;
+  ASSERT_EQ(lexer.Consume(&input, &token, 1), -1);
+  ASSERT_EQ(input, "!if");
+}
+
+TEST(Lexer, Priority) {
+  // Where two of the regexps match as much, the one added first wins.
+  RE2::Lexer lexer(RE2::DefaultOptions);
+  ASSERT_EQ(lexer.Add("[a-z]+", NULL), 0);
+  ASSERT_EQ(lexer.Add("for|while", NULL), 1);
+  ASSERT_EQ(lexer.Add("[a-z]+:", NULL), 2);
+  ASSERT_TRUE(lexer.Compile());
+
+  std::vector<std::pair<int, std::string>> want = {{0, "for"}};
+  ASSERT_EQ(Tokens(lexer, "for"), want);
+  want = {{2, "while:"}};
+  ASSERT_EQ(Tokens(lexer, "while:"), want);
+}
+
+TEST(Lexer, Submatches) {
+  RE2::Lexer lexer(RE2::DefaultOptions);
+  ASSERT_EQ(lexer.Add("(\\w+)=(\\w*)", NULL), 0);
+  ASSERT_EQ(lexer.Add("(\\w+)", NULL), 1);
+  ASSERT_EQ(lexer.Add(";", NULL), 2);
+  ASSERT_TRUE(lexer.Compile());
+
+  absl::string_view input("a=b;cd=;e");
+  absl::string_view sub[4];
+  ASSERT_EQ(lexer.Consume(&input, sub, 4), 0);
+  ASSERT_EQ(sub[0], "a=b");
+  ASSERT_EQ(sub[1], "a");
+  ASSERT_EQ(sub[2], "b");
+  ASSERT_EQ(sub[3].data(), nullptr);
+  ASSERT_EQ(lexer.Consume(&input, sub, 4), 2);
+  ASSERT_EQ(sub[0], ";");
+  ASSERT_EQ(sub[1].data(), nullptr);
+  ASSERT_EQ(lexer.Consume(&input, sub, 3), 0);
+  ASSERT_EQ(sub[0], "cd=");
+  ASSERT_EQ(sub[1], "cd");
+  ASSERT_EQ(sub[2], "");
+  ASSERT_EQ(lexer.Consume(&input, NULL, 0), 2);
+  ASSERT_EQ(lexer.Consume(&input, sub, 2), 1);
+  ASSERT_EQ(sub[1], "e");
+  ASSERT_EQ(input, "");
+  ASSERT_EQ(lexer.Consume(&input, sub, 2), -1);
+}
+
+TEST(Lexer, Context) {
+  // Each token is matched as though the text began where it does, and
+  // the text after it is taken into account.
+  RE2::Lexer lexer(RE2::DefaultOptions);
+  ASSERT_EQ(lexer.Add("^#.*", NULL), 0);
+  ASSERT_EQ(lexer.Add("end$", NULL), 1);
+  ASSERT_EQ(lexer.Add("\\w+\\b", NULL), 2);
+  ASSERT_EQ(lexer.Add("\\W", NULL), 3);
+  ASSERT_TRUE(lexer.Compile());
+
+  std::vector<std::pair<int, std::string>> want = {
+    {0, "#x"}, {3, "\n"}, {2, "end"}, {3, " "}, {1, "end"},
+  };
+  ASSERT_EQ(Tokens(lexer, "#x\nend end"), want);
+}
+
+TEST(Lexer, Errors) {
+  RE2::Lexer lexer(RE2::Quiet);
+  std::string error;
+  ASSERT_EQ(lexer.Add("a", &error), 0);
+  ASSERT_EQ(lexer.Add("(", &error), -1);
+  ASSERT_FALSE(error.empty());
+  ASSERT_EQ(lexer.Add("b", &error), 1);
+  ASSERT_TRUE(lexer.Compile());
+  ASSERT_EQ(lexer.GetRE2(1).pattern(), "b");
+
+  std::vector<std::pair<int, std::string>> want = {{1, "b"}, {0, "a"}};
+  ASSERT_EQ(Tokens(lexer, "ba"), want);
+
+  RE2::Lexer empty(RE2::DefaultOptions);
+  ASSERT_TRUE(empty.Compile());
+  absl::string_view input("a");
+  ASSERT_EQ(empty.Consume(&input, NULL, 0), -1);
+}
+
+TEST(Lexer, Latin1) {
+  RE2::Lexer lexer(RE2::Latin1);
+  ASSERT_EQ(lexer.Add("\xe9+", NULL), 0);
+  ASSERT_EQ(lexer.Add(".", NULL), 1);
+  ASSERT_TRUE(lexer.Compile());
+
+  std::vector<std::pair<int, std::string>> want = {
+    {0, "\xe9\xe9"}, {1, "\xc3"}, {0, "\xe9"},
+  };
+  ASSERT_EQ(Tokens(lexer, "\xe9\xe9\xc3\xe9"), want);
+}
+
+}  // namespace re2
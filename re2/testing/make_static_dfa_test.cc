@@ -0,0 +1,70 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+// Tests the headers that the build generates by running make_static_dfa:
+// see re2_static_dfa() in CMakeLists.txt, the genrules in BUILD.bazel and
+// the obj/gen rules in the Makefile.  The flags and patterns used there
+// must be kept in sync with the ones below.  The generated tables and the
+// StaticDFA itself are constexpr, so compiling this file checks that too.
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "gtest/gtest.h"
+#include "re2/re2.h"
+#include "re2/static_dfa.h"
+#include "re2/testing/string_generator.h"
+
+// Included twice in order to exercise the include guard.
+#include "static_dfa_hostname.h"
+#include "static_dfa_hostname.h"
+#include "static_dfa_keyword.h"
+
+namespace re2 {
+
+// Generated with --full_match --namespace=re2::static_dfa_test.
+static const char kHostname[] = "[a-z0-9-]+(\\.[a-z0-9-]+)*";
+
+// Generated with --case_insensitive and no namespace.
+static const char kKeyword[] = "\\b(select|from)\\b";
+
+TEST(MakeStaticDFA, FullMatchInNamespace) {
+  RE2 re(kHostname);
+  ASSERT_TRUE(re.ok());
+  const StaticDFA& dfa = static_dfa_test::HostnameDFA();
+
+  EXPECT_TRUE(dfa.Match("www.example.com"));
+  EXPECT_FALSE(dfa.Match("www..example.com"));
+  EXPECT_FALSE(dfa.Match(" www.example.com"));
+
+  std::vector<std::string> alphabet = {"a", "0", "-", ".", "A", " "};
+  StringGenerator g(6, alphabet);
+  while (g.HasNext()) {
+    absl::string_view text = g.Next();
+    EXPECT_EQ(RE2::FullMatch(text, re), dfa.Match(text))
+        << "on \"" << text << "\"";
+  }
+}
+
+TEST(MakeStaticDFA, PartialMatchInGlobalNamespace) {
+  RE2::Options options;
+  options.set_case_sensitive(false);
+  RE2 re(kKeyword, options);
+  ASSERT_TRUE(re.ok());
+  const StaticDFA& dfa = ::KeywordDFA();
+
+  EXPECT_TRUE(dfa.Match("SELECT * FROM t"));
+  EXPECT_FALSE(dfa.Match("selection"));
+
+  std::vector<std::string> alphabet = {"select", "FrOm", "x", " ", "_", "\n"};
+  StringGenerator g(4, alphabet);
+  while (g.HasNext()) {
+    absl::string_view text = g.Next();
+    EXPECT_EQ(RE2::PartialMatch(text, re), dfa.Match(text))
+        << "on \"" << text << "\"";
+  }
+}
+
+}  // namespace re2
@@ -250,6 +250,18 @@ static Test tests[] = {
   { "\xa5\xd1|\xa5\x64", "cat{lit{\xa5}cc{0x44 0x64 0xd1}}", Regexp::Latin1 | Regexp::FoldCase },
   { "\xa5\x64|\xa5[\xd1\xd2]", "cat{lit{\xa5}cc{0x44 0x64 0xd1-0xd2}}", Regexp::Latin1 | Regexp::FoldCase },
   { "\xa5[\xd1\xd2]|\xa5\x64", "cat{lit{\xa5}cc{0x44 0x64 0xd1-0xd2}}", Regexp::Latin1 | Regexp::FoldCase },
+
+  // Runs of literals, which are parsed all at once, must leave
+  // the last literal to any repetition operator that follows.
+  { "abc*", "cat{str{ab}star{lit{c}}}" },
+  { "ab\\.c+d", "cat{str{ab.}plus{lit{c}}lit{d}}" },
+  { "abc{2}", "cat{str{ab}rep{2,2 lit{c}}}" },
+  { "ab\\{2}", "str{ab{2}}" },
+  { "a\\.b\\*\\*", "str{a.b**}" },
+  { "a(bc)de", "cat{lit{a}cap{str{bc}}str{de}}" },
+  { "a\\A12", "cat{lit{a}bot{}str{12}}" },
+  { "12(?i:ab)34", "cat{str{12}strfold{ab}str{34}}" },
+  { "(?i)1\\.2", "str{1.2}" },
 };
 
 bool RegexpEqualTestingOnly(Regexp* a, Regexp* b) {
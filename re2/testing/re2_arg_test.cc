@@ -10,6 +10,9 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <limits>
+#include <string>
+
 #include "absl/base/macros.h"
 #include "absl/log/absl_log.h"
 #include "absl/types/optional.h"
@@ -135,6 +138,73 @@ TEST(RE2ArgTest, Uint64Test) {
   PARSE_FOR_TYPE(uint64_t, 5);
 }
 
+TEST(RE2ArgTest, IntegerSyntaxTest) {
+  int i;
+  EXPECT_TRUE(RE2::Arg(&i).Parse("+12", 3));
+  EXPECT_EQ(i, 12);
+  EXPECT_FALSE(RE2::Arg(&i).Parse(" 12", 3));
+  EXPECT_FALSE(RE2::Arg(&i).Parse("12 ", 3));
+  EXPECT_FALSE(RE2::Arg(&i).Parse("+-12", 4));
+  EXPECT_FALSE(RE2::Arg(&i).Parse("-", 1));
+  EXPECT_FALSE(RE2::Arg(&i).Parse("0x12", 4));
+  EXPECT_TRUE(RE2::Arg(&i).Parse("123", 2));  // Only as much as it's told.
+  EXPECT_EQ(i, 12);
+
+  EXPECT_TRUE(RE2::Hex(&i).Parse("-0X1f", 5));
+  EXPECT_EQ(i, -31);
+  EXPECT_TRUE(RE2::Hex(&i).Parse("1F", 2));
+  EXPECT_EQ(i, 31);
+  EXPECT_FALSE(RE2::Hex(&i).Parse("0x", 2));
+  EXPECT_FALSE(RE2::Hex(&i).Parse("0xg", 3));
+  EXPECT_FALSE(RE2::Octal(&i).Parse("18", 2));
+  EXPECT_FALSE(RE2::Octal(&i).Parse("0x1", 3));
+  EXPECT_TRUE(RE2::CRadix(&i).Parse("010", 3));
+  EXPECT_EQ(i, 8);
+  EXPECT_TRUE(RE2::CRadix(&i).Parse("0", 1));
+  EXPECT_EQ(i, 0);
+  EXPECT_FALSE(RE2::CRadix(&i).Parse("09", 2));
+
+  // Leading zeros don't count towards any limit on length.
+  std::string zeros(100, '0');
+  std::string str = "0x" + zeros + "7fffffff";
+  EXPECT_TRUE(RE2::CRadix(&i).Parse(str.data(), str.size()));
+  EXPECT_EQ(i, 0x7fffffff);
+  str = "0x" + zeros + "80000000";
+  EXPECT_FALSE(RE2::CRadix(&i).Parse(str.data(), str.size()));
+
+  unsigned int u;
+  EXPECT_FALSE(RE2::Arg(&u).Parse("-0", 2));
+  EXPECT_TRUE(RE2::Hex(&u).Parse("ffffffff", 8));
+  EXPECT_EQ(u, 0xffffffffU);
+  EXPECT_FALSE(RE2::Hex(&u).Parse("100000000", 9));
+}
+
+TEST(RE2ArgTest, FloatSyntaxTest) {
+  double d;
+  EXPECT_TRUE(RE2::Arg(&d).Parse("+1.5", 4));
+  EXPECT_EQ(d, 1.5);
+  EXPECT_TRUE(RE2::Arg(&d).Parse("  -.5e1", 7));
+  EXPECT_EQ(d, -5);
+  EXPECT_TRUE(RE2::Arg(&d).Parse("0x1.8p1", 7));
+  EXPECT_EQ(d, 3);
+  EXPECT_TRUE(RE2::Arg(&d).Parse("-inf", 4));
+  EXPECT_EQ(d, -std::numeric_limits<double>::infinity());
+  EXPECT_TRUE(RE2::Arg(&d).Parse("1.25", 3));  // Only as much as it's told.
+  EXPECT_EQ(d, 1.2);
+  EXPECT_FALSE(RE2::Arg(&d).Parse("1.5 ", 4));
+  EXPECT_FALSE(RE2::Arg(&d).Parse("  ", 2));
+  EXPECT_FALSE(RE2::Arg(&d).Parse("-+1", 3));
+  EXPECT_FALSE(RE2::Arg(&d).Parse("1e", 2));
+  EXPECT_FALSE(RE2::Arg(&d).Parse("0x", 2));
+  EXPECT_FALSE(RE2::Arg(&d).Parse("1,5", 3));
+  EXPECT_FALSE(RE2::Arg(&d).Parse("1e400", 5));
+
+  float f;
+  EXPECT_TRUE(RE2::Arg(&f).Parse("0.1", 3));
+  EXPECT_EQ(f, 0.1f);
+  EXPECT_FALSE(RE2::Arg(&f).Parse("1e40", 4));
+}
+
 TEST(RE2ArgTest, ParseFromTest) {
   struct {
     bool ParseFrom(const char* str, size_t n) {
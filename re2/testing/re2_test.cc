@@ -12,7 +12,9 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -189,9 +191,131 @@ TEST(RE2, Replace) {
     ASSERT_EQ(RE2::GlobalReplace(&all, t->regexp, t->rewrite), t->greplace_count)
       << "Got: " << all;
     ASSERT_EQ(all, t->global);
+
+    RE2 re(t->regexp);
+    RE2::RewriteTemplate rewrite(re, t->rewrite);
+    ASSERT_TRUE(rewrite.ok()) << rewrite.error();
+    one = t->original;
+    ASSERT_TRUE(RE2::Replace(&one, re, rewrite));
+    ASSERT_EQ(one, t->single);
+    all = t->original;
+    ASSERT_EQ(RE2::GlobalReplace(&all, re, rewrite), t->greplace_count)
+      << "Got: " << all;
+    ASSERT_EQ(all, t->global);
+  }
+}
+
+// Does what GlobalReplace() does by finding one match at a time with
+// Match() and copying.
+static std::string GlobalReplaceByMatch(const RE2& re, absl::string_view text,
+                                        absl::string_view rewrite,
+                                        int* count) {
+  std::string out;
+  *count = 0;
+  int nvec = 1 + RE2::MaxSubmatch(rewrite);
+  absl::string_view vec[10];
+  const char* p = text.data();
+  const char* ep = text.data() + text.size();
+  const char* lastend = NULL;
+  while (p <= ep && re.Match(text, p - text.data(), text.size(),
+                             RE2::UNANCHORED, vec, nvec)) {
+    out.append(p, vec[0].data() - p);
+    if (vec[0].data() == lastend && vec[0].empty()) {
+      // Step over one rune: these texts are all valid UTF-8.
+      int n = 1;
+      while (p + n < ep && (p[n] & 0xC0) == 0x80)
+        n++;
+      if (p < ep)
+        out.append(p, n);
+      p += n;
+      continue;
+    }
+    re.Rewrite(&out, rewrite, vec, nvec);
+    p = lastend = vec[0].data() + vec[0].size();
+    (*count)++;
+  }
+  if (p < ep)
+    out.append(p, ep - p);
+  return out;
+}
+
+// GlobalReplace() finds matches a batch at a time where it can and writes
+// the result in place, so check it against GlobalReplaceByMatch() on text
+// with many matches.
+TEST(RE2, GlobalReplaceManyMatches) {
+  static const char* regexps[] = {
+    "\\d+",
+    "(\\d+)-(\\d*)",
+    "x*",
+    "\\b",
+    "\\b\\w",
+    "(?m)^.",
+    "(?:\xc3\xa9|a)?",
+    "[a-z]+|(\\d)",
+    "\\pL{2}",
+  };
+  // Rewrites that make the text shorter, longer or both.
+  static const char* rewrites[] = {
+    "",
+    "#",
+    "<\\0>",
+    "\\1\\1\\1",
+    "\\2\\1",
+  };
+  std::string text;
+  for (int i = 0; i < 300; i++)
+    absl::StrAppendFormat(&text, "ab%d-%d \xc3\xa9x%s", i, i * 7 % 5,
+                          i % 10 == 0 ? "\n" : "");
+
+  for (const char* regexp : regexps) {
+    RE2 re(regexp);
+    ASSERT_TRUE(re.ok()) << regexp;
+    for (const char* rewrite : rewrites) {
+      if (RE2::MaxSubmatch(rewrite) > re.NumberOfCapturingGroups())
+        continue;
+      int count;
+      std::string want = GlobalReplaceByMatch(re, text, rewrite, &count);
+
+      std::string got(text);
+      ASSERT_EQ(RE2::GlobalReplace(&got, re, rewrite), count)
+          << regexp << " " << rewrite;
+      ASSERT_EQ(got, want) << regexp << " " << rewrite;
+
+      got.clear();
+      ASSERT_EQ(RE2::GlobalReplace(text, re, rewrite,
+                                   [&](absl::string_view s) {
+                                     got.append(s.data(), s.size());
+                                   }),
+                count)
+          << regexp << " " << rewrite;
+      ASSERT_EQ(got, want) << regexp << " " << rewrite;
+    }
   }
 }
 
+TEST(RE2, GlobalReplaceSink) {
+  RE2 re("(\\w+)@(\\w+)");
+  RE2::RewriteTemplate rewrite(re, "\\2!\\1");
+  std::vector<std::string> pieces;
+  auto sink = [&](absl::string_view s) { pieces.emplace_back(s); };
+
+  ASSERT_EQ(RE2::GlobalReplace("to a@b, c@d.", re, rewrite, sink), 2);
+  ASSERT_EQ(pieces, std::vector<std::string>({"to ", "b!a", ", ", "d!c", "."}));
+
+  // All of the text is passed even if nothing matches.
+  pieces.clear();
+  ASSERT_EQ(RE2::GlobalReplace("to nobody", re, "\\1", sink), 0);
+  ASSERT_EQ(pieces, std::vector<std::string>({"to nobody"}));
+
+  // Nothing is passed if the rewrite can't be used.
+  pieces.clear();
+  ASSERT_EQ(RE2::GlobalReplace("to a@b", re, "\\3", sink), -1);
+  ASSERT_EQ(RE2::GlobalReplace("to a@b", re, RE2::RewriteTemplate(re, "\\"),
+                               sink),
+            -1);
+  ASSERT_TRUE(pieces.empty());
+}
+
 static void TestCheckRewriteString(const char* regexp, const char* rewrite,
                               bool expect_ok) {
   std::string error;
@@ -229,6 +353,41 @@ TEST(RE2, Extract) {
   ASSERT_EQ(s, "'foo'");
 }
 
+TEST(RE2, RewriteTemplate) {
+  RE2 re("(.*)@([^.]*)");
+  std::string s;
+
+  RE2::RewriteTemplate rewrite(re, "\\2!\\1 \\\\\\0\\12");
+  ASSERT_TRUE(rewrite.ok()) << rewrite.error();
+  ASSERT_EQ(rewrite.max_submatch(), 2);
+  ASSERT_TRUE(RE2::Extract("boris@kremvax.ru", re, rewrite, &s));
+  ASSERT_EQ(s, "kremvax!boris \\boris@kremvaxboris2");
+  // check that false match doesn't overwrite
+  ASSERT_FALSE(RE2::Extract("baz", re, rewrite, &s));
+  ASSERT_EQ(s, "kremvax!boris \\boris@kremvaxboris2");
+
+  RE2::RewriteTemplate literal(re, "x");
+  ASSERT_TRUE(literal.ok()) << literal.error();
+  ASSERT_EQ(literal.max_submatch(), 0);
+  s = "a@b.ru";
+  ASSERT_TRUE(RE2::Replace(&s, re, literal));
+  ASSERT_EQ(s, "x.ru");
+
+  RE2::RewriteTemplate bad(re, "\\3");
+  ASSERT_FALSE(bad.ok());
+  ASSERT_FALSE(bad.error().empty());
+  ASSERT_FALSE(RE2::Extract("a@b", re, bad, &s));
+  s = "a@b";
+  ASSERT_FALSE(RE2::Replace(&s, re, bad));
+  ASSERT_EQ(RE2::GlobalReplace(&s, re, bad), 0);
+  ASSERT_EQ(s, "a@b");
+  ASSERT_FALSE(RE2::RewriteTemplate(re, "\\").ok());
+  ASSERT_FALSE(RE2::RewriteTemplate(re, "\\x").ok());
+
+  // A template used with a regexp that has too few groups fails.
+  ASSERT_FALSE(RE2::Extract("a@b", RE2("(a)"), rewrite, &s));
+}
+
 TEST(RE2, MaxSubmatchTooLarge) {
   std::string s;
   ASSERT_FALSE(RE2::Extract("foo", "f(o+)", "\\1\\2", &s));
@@ -299,6 +458,246 @@ TEST(RE2, FindAndConsume) {
   ASSERT_EQ(input, "");
 }
 
+TEST(RE2, FindAll) {
+  RE2 r("(\\w+)");
+  std::string s("   aaa b!@#$@#$cccc");
+  std::vector<std::string> words;
+  absl::string_view sub[2];
+  for (const absl::string_view* m : RE2::FindAll(s, r, sub, 2)) {
+    ASSERT_EQ(m, sub);
+    ASSERT_EQ(m[0], m[1]);
+    words.emplace_back(m[1]);
+  }
+  ASSERT_EQ(words, std::vector<std::string>({"aaa", "b", "cccc"}));
+
+  // Empty matches are passed over at the end of the last match, as they
+  // are by GlobalReplace(), and otherwise step over a whole rune.
+  RE2 e("a*");
+  s = "baa\xc3\xa9" "a";
+  RE2::FindAll all(s, e, sub, 1);
+  std::vector<size_t> offsets;
+  while (all.Next())
+    offsets.push_back(sub[0].data() - s.data());
+  ASSERT_EQ(offsets, std::vector<size_t>({0, 1, 5}));
+  ASSERT_FALSE(all.Next());
+
+  // No matches at all.
+  RE2::FindAll none("!@#", r, sub, 1);
+  ASSERT_TRUE(none.begin() == none.end());
+}
+
+// FindAll() finds matches a batch at a time where it can, so check it
+// against Match() on text with many matches.
+TEST(RE2, FindAllManyMatches) {
+  static const char* regexps[] = {
+    "\\d+",
+    "(\\d+)-(\\d*)",
+    "x*",
+    "\\b",
+    "(?m)^.",
+    "(?:\xc3\xa9|a)?",
+    "[a-z]+|(\\d)",
+  };
+  std::string text;
+  for (int i = 0; i < 300; i++)
+    absl::StrAppendFormat(&text, "ab%d-%d \xc3\xa9x%s", i, i * 7 % 5,
+                          i % 10 == 0 ? "\n" : "");
+
+  for (const char* regexp : regexps) {
+    RE2 re(regexp);
+    ASSERT_TRUE(re.ok()) << regexp;
+    // Few enough submatches to be found a batch at a time, and too many.
+    for (int nsub : {1, 3, 40}) {
+      std::vector<absl::string_view> want(nsub);
+      std::vector<absl::string_view> got(nsub);
+      RE2::FindAll all(text, re, got.data(), nsub);
+      const char* p = text.data();
+      const char* ep = text.data() + text.size();
+      const char* lastend = NULL;
+      int count = 0;
+      while (p <= ep && re.Match(text, p - text.data(), text.size(),
+                                 RE2::UNANCHORED, want.data(), nsub)) {
+        if (want[0].data() == lastend && want[0].empty()) {
+          // Step over one rune: the text is all valid UTF-8.
+          int n = 1;
+          while (p + n < ep && (p[n] & 0xC0) == 0x80)
+            n++;
+          p += n;
+          continue;
+        }
+        ASSERT_TRUE(all.Next()) << regexp << " " << count;
+        for (int i = 0; i < nsub; i++) {
+          ASSERT_EQ(got[i].data(), want[i].data()) << regexp << " " << count;
+          ASSERT_EQ(got[i].size(), want[i].size()) << regexp << " " << count;
+        }
+        p = lastend = want[0].data() + want[0].size();
+        count++;
+      }
+      ASSERT_FALSE(all.Next()) << regexp;
+      ASSERT_GT(count, 10) << regexp;
+    }
+  }
+}
+
+TEST(RE2, Split) {
+  // The same as Python's re.split(), with None as "<none>", except where
+  // a non-empty match follows an empty match at the same position.
+  static const struct {
+    const char* regexp;
+    const char* text;
+    int maxsplit;
+    int nsplit;
+    std::vector<const char*> pieces;
+  } tests[] = {
+    { ",", "a,b,,c,", 0, 4, { "a", "b", "", "c", "" } },
+    { ",", "a,b,,c,", 2, 2, { "a", "b", ",c," } },
+    { ",", "abc", -1, 0, { "abc" } },
+    { ",", "", 0, 0, { "" } },
+    { ",", ",", 0, 1, { "", "" } },
+    { "(?i)ab", "xAbyaBz", 0, 2, { "x", "y", "z" } },
+    { ", *", "a, b,c", 0, 2, { "a", "b", "c" } },
+    { "(,)|(;)", "a,b;c", 0, 2, { "a", ",", "<none>", "b", "<none>", ";",
+                                  "c" } },
+    { "(-)?x", "axb-xc", 0, 2, { "a", "<none>", "b", "-", "c" } },
+    { "x*", "axbc", 0, 5, { "", "a", "", "b", "c", "" } },
+    { "x*", "ax", 0, 3, { "", "a", "", "" } },
+    { "x*", "", 0, 1, { "", "" } },
+    { "", "ab", 0, 3, { "", "a", "b", "" } },
+    { "", "\xc3\xa9\xc3\xa9", 0, 3, { "", "\xc3\xa9", "\xc3\xa9", "" } },
+    { "\\s*", "a b", 0, 4, { "", "a", "", "b", "" } },
+    { "\\b", "hi there", 0, 4, { "", "hi", " ", "there", "" } },
+    { "x*", "axbxc", 2, 2, { "", "a", "bxc" } },
+    // Python gives "", "", "", "b", "".
+    { "|a", "ab", 0, 3, { "", "a", "b", "" } },
+  };
+  for (const auto& t : tests) {
+    std::vector<absl::string_view> pieces = {"untouched"};
+    ASSERT_EQ(RE2::Split(t.text, t.regexp, t.maxsplit, &pieces), t.nsplit)
+        << t.regexp << " " << t.text;
+    std::vector<std::string> got;
+    for (absl::string_view piece : pieces)
+      got.push_back(piece.data() == NULL ? "<none>" : std::string(piece));
+    std::vector<std::string> want = {"untouched"};
+    want.insert(want.end(), t.pieces.begin(), t.pieces.end());
+    ASSERT_EQ(got, want) << t.regexp << " " << t.text;
+  }
+
+  // The pieces point into the text.
+  std::string text = "key=value";
+  std::vector<absl::string_view> pieces;
+  ASSERT_EQ(RE2::Split(text, "=", 0, &pieces), 1);
+  ASSERT_EQ(pieces[0].data(), text.data());
+  ASSERT_EQ(pieces[1].data(), text.data() + 4);
+}
+
+// Checks that MatchChunks() on chunks finds what Match() finds on all of
+// the text at once.
+static void TestMatchChunks(const RE2& re, const std::string& text,
+                            const std::vector<absl::string_view>& chunks) {
+  int nsub = 1 + re.NumberOfCapturingGroups();
+  for (RE2::Anchor anchor :
+       {RE2::UNANCHORED, RE2::ANCHOR_START, RE2::ANCHOR_BOTH}) {
+    std::vector<absl::string_view> want(nsub);
+    bool matched = re.Match(text, 0, text.size(), anchor, want.data(), nsub);
+    ASSERT_EQ(re.MatchChunks(chunks.data(), static_cast<int>(chunks.size()),
+                             anchor, NULL, 0, NULL, NULL),
+              matched)
+        << re.pattern() << " " << text;
+
+    std::vector<absl::string_view> sub(nsub);
+    std::string buf;
+    size_t pos;
+    ASSERT_EQ(re.MatchChunks(chunks.data(), static_cast<int>(chunks.size()),
+                             anchor, sub.data(), nsub, &buf, &pos),
+              matched)
+        << re.pattern() << " " << text;
+    if (!matched)
+      continue;
+    ASSERT_EQ(pos, static_cast<size_t>(want[0].data() - text.data()))
+        << re.pattern() << " " << text;
+    for (int i = 0; i < nsub; i++) {
+      if (want[i].data() == NULL) {
+        ASSERT_EQ(sub[i].data(), nullptr) << re.pattern() << " " << i;
+        continue;
+      }
+      ASSERT_EQ(sub[i], want[i]) << re.pattern() << " " << text << " " << i;
+      ASSERT_EQ(sub[i].data() - sub[0].data(), want[i].data() - want[0].data())
+          << re.pattern() << " " << text << " " << i;
+    }
+  }
+}
+
+TEST(RE2, MatchChunks) {
+  struct {
+    const char* regexp;
+    const char* text;
+  } tests[] = {
+    { "hello", "xxhelloxx" },
+    { "hello", "xxhellxx" },
+    { "(\\w+)@(\\w+)\\.com", "mail bob@example.com now" },
+    { "\\bab\\b", "cab ab" },
+    { "\\Bb", "b ab" },
+    { "^ab", "ab" },
+    { "^(?i)abc(d+)", "ABcddd" },
+    { "^abc", "abd" },
+    { "(?m)^b$", "a\nb\nc" },
+    { "c$", "abc" },
+    { "(a+)(b*)", "xxaaabbbaab" },
+    { "x*", "abc" },
+    { "(?i)hello", "xxHeLLoxx" },
+    { "a[^x]*b", "aaaaaab" },
+    { "(\\d+)-(\\d+)|(z)", "ab 12-34 z" },
+    { "\\w+$", "ab cd" },
+  };
+  for (const auto& t : tests) {
+    for (bool longest : {false, true}) {
+      RE2::Options options;
+      options.set_longest_match(longest);
+      RE2 re(t.regexp, options);
+      ASSERT_TRUE(re.ok()) << t.regexp;
+      std::string text(t.text);
+
+      // Every way of splitting the text in two or three, with the odd
+      // empty chunk, and one byte per chunk.
+      std::vector<absl::string_view> chunks;
+      for (size_t i = 0; i <= text.size(); i++) {
+        for (size_t j = i; j <= text.size(); j++) {
+          absl::string_view s(text);
+          chunks = {s.substr(0, i), s.substr(i, j - i), s.substr(j)};
+          TestMatchChunks(re, text, chunks);
+        }
+      }
+      chunks.clear();
+      for (size_t i = 0; i < text.size(); i++)
+        chunks.push_back(absl::string_view(text).substr(i, 1));
+      TestMatchChunks(re, text, chunks);
+    }
+  }
+
+  // Where the match crosses chunks, it ends up in buf.
+  RE2 re("(\\w+)=(\\w+)");
+  std::string s1 = "a key", s2 = "=val c=d";
+  absl::string_view chunks[] = {s1, s2};
+  absl::string_view sub[3];
+  std::string buf;
+  size_t pos;
+  ASSERT_TRUE(re.MatchChunks(chunks, 2, RE2::UNANCHORED, sub, 3, &buf, &pos));
+  ASSERT_EQ(pos, 2);
+  ASSERT_EQ(sub[0], "key=val");
+  ASSERT_EQ(sub[1], "key");
+  ASSERT_EQ(sub[2], "val");
+  ASSERT_EQ(buf, " key=val ");
+  ASSERT_EQ(sub[0].data(), buf.data() + 1);
+  ASSERT_TRUE(re.MatchChunks(chunks + 1, 1, RE2::UNANCHORED, sub, 3, &buf,
+                             &pos));
+  ASSERT_EQ(pos, 5);
+  ASSERT_EQ(sub[0], "c=d");
+  ASSERT_EQ(sub[0].data(), s2.data() + 5);
+  ASSERT_FALSE(re.MatchChunks(chunks, 2, RE2::ANCHOR_START, sub, 3, &buf,
+                              &pos));
+  ASSERT_FALSE(re.MatchChunks(NULL, 0, RE2::UNANCHORED, NULL, 0, NULL, NULL));
+}
+
 TEST(RE2, FindAndConsumeN) {
   const std::string s(" one two three 4");
   absl::string_view input(s);
@@ -1688,4 +2087,116 @@ TEST(RE2, Issue477) {
   ASSERT_EQ(s, "\x61\x63");
 }
 
+TEST(RE2, LiteralMatch) {
+  // Each of these patterns is a literal string, so RE2 will search for it
+  // without running any of the automata. Check the answers against those
+  // from the same patterns with a capturing group, which forces the usual
+  // matching code. Case-insensitive literals longer than nine bytes are of
+  // special interest because the "Shift DFA" only handles nine bytes.
+  struct {
+    const char* literal;
+    bool case_sensitive;
+    const char* text;
+  } tests[] = {
+    { "x", true, "abcxdefx" },
+    { "x", true, "abcdef" },
+    { "def", true, "abcdefdef" },
+    { "def", true, "abcdEf" },
+    { "def", false, "abcdEfDEF" },
+    { "hello, world", true, "say hello, world!" },
+    { "hello, world", false, "say HELLO, World!" },
+    { "hello, world", false, "say HELLO, Worl" },
+    { "hello, world", false, "say hello, worle hello, world" },
+    { "aaaaaaaaab", false, "aaaaaaaaaaaaaaaaaAaAaAab" },
+    { "\\x{2603}", true, "let it \xe2\x98\x83 snow" },
+  };
+  for (const auto& t : tests) {
+    RE2::Options options;
+    options.set_case_sensitive(t.case_sensitive);
+    RE2 re(t.literal, options);
+    ASSERT_TRUE(re.ok());
+    RE2 group(absl::StrFormat("(%s)", t.literal), options);
+    ASSERT_TRUE(group.ok());
+
+    absl::string_view text(t.text);
+    for (RE2::Anchor anchor : {RE2::UNANCHORED, RE2::ANCHOR_START,
+                               RE2::ANCHOR_BOTH}) {
+      for (size_t startpos = 0; startpos <= text.size(); startpos++) {
+        absl::string_view m1, m2;
+        bool b1 = re.Match(text, startpos, text.size(), anchor, &m1, 1);
+        bool b2 = group.Match(text, startpos, text.size(), anchor, &m2, 1);
+        ASSERT_EQ(b1, b2) << t.literal << " " << text << " " << startpos;
+        if (b1) {
+          ASSERT_EQ(m1.data(), m2.data());
+          ASSERT_EQ(m1.size(), m2.size());
+        }
+        ASSERT_EQ(b1, re.Match(text, startpos, text.size(), anchor, NULL, 0));
+      }
+    }
+  }
+
+  std::string s = "the quick brown fox; The Quick Brown Fox";
+  EXPECT_EQ(2, RE2::GlobalReplace(&s, "(?i)quick", "slow"));
+  EXPECT_EQ("the slow brown fox; The slow Brown Fox", s);
+  EXPECT_TRUE(RE2::FullMatch("quick", "quick"));
+  EXPECT_FALSE(RE2::FullMatch("quick!", "quick"));
+  EXPECT_TRUE(RE2::PartialMatch("quick!", "quick"));
+}
+
+TEST(RE2, FromWords) {
+  std::vector<std::string> words = {"foo", "foobar", "fo", "bar", "a.b"};
+  std::unique_ptr<RE2> re = RE2::FromWords(words, RE2::DefaultOptions);
+  ASSERT_TRUE(re->ok());
+  EXPECT_EQ(re->pattern(), "foo|foobar|fo|bar|a\\.b");
+
+  // Leftmost-first matching prefers the earlier of two words, but the
+  // later one must still match when the earlier one can't.
+  absl::string_view m;
+  ASSERT_TRUE(re->Match("xfoobarx", 0, 8, RE2::UNANCHORED, &m, 1));
+  EXPECT_EQ(m, "foo");
+  ASSERT_TRUE(re->Match("fob", 0, 3, RE2::UNANCHORED, &m, 1));
+  EXPECT_EQ(m, "fo");
+  EXPECT_TRUE(RE2::FullMatch("foobar", *re));
+  EXPECT_TRUE(RE2::FullMatch("fo", *re));
+  EXPECT_TRUE(RE2::FullMatch("a.b", *re));
+  EXPECT_FALSE(RE2::FullMatch("axb", *re));
+  EXPECT_FALSE(RE2::FullMatch("foob", *re));
+
+  RE2::Options options;
+  options.set_longest_match(true);
+  re = RE2::FromWords(words, options);
+  ASSERT_TRUE(re->ok());
+  ASSERT_TRUE(re->Match("xfoobarx", 0, 8, RE2::UNANCHORED, &m, 1));
+  EXPECT_EQ(m, "foobar");
+
+  // Case folding covers orbits with more than two runes.
+  options.set_longest_match(false);
+  options.set_case_sensitive(false);
+  re = RE2::FromWords({"kelvin", "\xc3\xa9t\xc3\xa9"}, options);
+  ASSERT_TRUE(re->ok());
+  EXPECT_TRUE(RE2::FullMatch("KELVIN", *re));
+  EXPECT_TRUE(RE2::FullMatch("\xe2\x84\xaa" "elvin", *re));  // Kelvin sign
+  EXPECT_TRUE(RE2::FullMatch("\xc3\x89T\xc3\x89", *re));
+  EXPECT_FALSE(RE2::FullMatch("kelvi", *re));
+
+  // Words with newlines never match if so requested.
+  options.set_case_sensitive(true);
+  options.set_never_nl(true);
+  re = RE2::FromWords({"a\nb", "c"}, options);
+  ASSERT_TRUE(re->ok());
+  EXPECT_FALSE(RE2::PartialMatch("a\nb", *re));
+  EXPECT_TRUE(RE2::PartialMatch("c", *re));
+
+  // No words match nothing, not even the empty string.
+  re = RE2::FromWords({}, RE2::DefaultOptions);
+  ASSERT_TRUE(re->ok());
+  EXPECT_FALSE(RE2::PartialMatch("", *re));
+  EXPECT_FALSE(RE2::PartialMatch("x", *re));
+
+  // Invalid UTF-8 is an error, as it is in a pattern.
+  re = RE2::FromWords({"\xff"}, RE2::Quiet);
+  EXPECT_FALSE(re->ok());
+  EXPECT_EQ(re->error_code(), RE2::ErrorBadUTF8);
+}
+
 }  // namespace re2
@@ -8,8 +8,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
@@ -19,9 +22,11 @@
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "benchmark/benchmark.h"
+#include "re2/lexer.h"
 #include "re2/prog.h"
 #include "re2/re2.h"
 #include "re2/regexp.h"
+#include "re2/submatcher.h"
 #include "util/malloc_counter.h"
 #include "util/pcre.h"
 
@@ -136,8 +141,9 @@ typedef void SearchImpl(benchmark::State& state, const char* regexp,
                         bool expect_match);
 
 SearchImpl SearchDFA, SearchNFA, SearchOnePass, SearchBitState, SearchPCRE,
-    SearchRE2, SearchCachedDFA, SearchCachedNFA, SearchCachedOnePass,
-    SearchCachedBitState, SearchCachedPCRE, SearchCachedRE2;
+    SearchRE2, SearchCachedDFA, SearchCachedFlatDFA, SearchCachedNFA,
+    SearchCachedOnePass, SearchCachedBitState, SearchCachedPCRE,
+    SearchCachedRE2;
 
 typedef void ParseImpl(benchmark::State& state, const char* regexp,
                        absl::string_view text);
@@ -246,11 +252,13 @@ BENCHMARK_RANGE(Search_Easy2_CachedPCRE,    8, 16<<20)->ThreadRange(1, NumCPUs()
 BENCHMARK_RANGE(Search_Easy2_CachedRE2,     8, 16<<20)->ThreadRange(1, NumCPUs());
 
 void Search_Medium_CachedDFA(benchmark::State& state)     { Search(state, MEDIUM, SearchCachedDFA); }
+void Search_Medium_CachedFlatDFA(benchmark::State& state) { Search(state, MEDIUM, SearchCachedFlatDFA); }
 void Search_Medium_CachedNFA(benchmark::State& state)     { Search(state, MEDIUM, SearchCachedNFA); }
 void Search_Medium_CachedPCRE(benchmark::State& state)    { Search(state, MEDIUM, SearchCachedPCRE); }
 void Search_Medium_CachedRE2(benchmark::State& state)     { Search(state, MEDIUM, SearchCachedRE2); }
 
 BENCHMARK_RANGE(Search_Medium_CachedDFA,     8, 16<<20)->ThreadRange(1, NumCPUs());
+BENCHMARK_RANGE(Search_Medium_CachedFlatDFA, 8, 16<<20)->ThreadRange(1, NumCPUs());
 BENCHMARK_RANGE(Search_Medium_CachedNFA,     8, 256<<10)->ThreadRange(1, NumCPUs());
 #ifdef USEPCRE
 BENCHMARK_RANGE(Search_Medium_CachedPCRE,    8, 256<<10)->ThreadRange(1, NumCPUs());
@@ -258,11 +266,13 @@ BENCHMARK_RANGE(Search_Medium_CachedPCRE,    8, 256<<10)->ThreadRange(1, NumCPUs
 BENCHMARK_RANGE(Search_Medium_CachedRE2,     8, 16<<20)->ThreadRange(1, NumCPUs());
 
 void Search_Hard_CachedDFA(benchmark::State& state)     { Search(state, HARD, SearchCachedDFA); }
+void Search_Hard_CachedFlatDFA(benchmark::State& state) { Search(state, HARD, SearchCachedFlatDFA); }
 void Search_Hard_CachedNFA(benchmark::State& state)     { Search(state, HARD, SearchCachedNFA); }
 void Search_Hard_CachedPCRE(benchmark::State& state)    { Search(state, HARD, SearchCachedPCRE); }
 void Search_Hard_CachedRE2(benchmark::State& state)     { Search(state, HARD, SearchCachedRE2); }
 
 BENCHMARK_RANGE(Search_Hard_CachedDFA,     8, 16<<20)->ThreadRange(1, NumCPUs());
+BENCHMARK_RANGE(Search_Hard_CachedFlatDFA, 8, 16<<20)->ThreadRange(1, NumCPUs());
 BENCHMARK_RANGE(Search_Hard_CachedNFA,     8, 256<<10)->ThreadRange(1, NumCPUs());
 #ifdef USEPCRE
 BENCHMARK_RANGE(Search_Hard_CachedPCRE,    8, 4<<10)->ThreadRange(1, NumCPUs());
@@ -282,11 +292,13 @@ BENCHMARK_RANGE(Search_Fanout_CachedPCRE,    8, 4<<10)->ThreadRange(1, NumCPUs()
 BENCHMARK_RANGE(Search_Fanout_CachedRE2,     8, 16<<20)->ThreadRange(1, NumCPUs());
 
 void Search_Parens_CachedDFA(benchmark::State& state)     { Search(state, PARENS, SearchCachedDFA); }
+void Search_Parens_CachedFlatDFA(benchmark::State& state) { Search(state, PARENS, SearchCachedFlatDFA); }
 void Search_Parens_CachedNFA(benchmark::State& state)     { Search(state, PARENS, SearchCachedNFA); }
 void Search_Parens_CachedPCRE(benchmark::State& state)    { Search(state, PARENS, SearchCachedPCRE); }
 void Search_Parens_CachedRE2(benchmark::State& state)     { Search(state, PARENS, SearchCachedRE2); }
 
 BENCHMARK_RANGE(Search_Parens_CachedDFA,     8, 16<<20)->ThreadRange(1, NumCPUs());
+BENCHMARK_RANGE(Search_Parens_CachedFlatDFA, 8, 16<<20)->ThreadRange(1, NumCPUs());
 BENCHMARK_RANGE(Search_Parens_CachedNFA,     8, 256<<10)->ThreadRange(1, NumCPUs());
 #ifdef USEPCRE
 BENCHMARK_RANGE(Search_Parens_CachedPCRE,    8, 8)->ThreadRange(1, NumCPUs());
@@ -787,6 +799,27 @@ BENCHMARK(BM_Regexp_SimplifyCompile)->ThreadRange(1, NumCPUs());
 BENCHMARK(BM_Regexp_NullWalk)->ThreadRange(1, NumCPUs());
 BENCHMARK(BM_RE2_Compile)->ThreadRange(1, NumCPUs());
 
+// Parses a machine-generated pattern: an alternation of state.range(0)
+// quoted URLs.  Parsing should take time linear in the pattern length.
+void BM_Regexp_ParseURLs(benchmark::State& state) {
+  std::string regexp;
+  for (int i = 0; i < state.range(0); i++) {
+    if (i > 0)
+      regexp += "|";
+    regexp += RE2::QuoteMeta(absl::StrFormat(
+        "https://www.example%d.com/path/to/page%d.html?q=a+b", i % 97, i));
+  }
+  for (auto _ : state) {
+    Regexp* re = Regexp::Parse(regexp, Regexp::LikePerl, NULL);
+    ABSL_CHECK(re);
+    re->Decref();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          regexp.size());
+}
+
+BENCHMARK_RANGE(BM_Regexp_ParseURLs, 8, 8<<10);
+
 // Makes text of size nbytes, then calls run to search
 // the text for regexp iters times.
 void SearchPhone(benchmark::State& state, ParseImpl* search) {
@@ -1019,6 +1052,20 @@ void SearchCachedDFA(benchmark::State& state, const char* regexp,
   }
 }
 
+void SearchCachedFlatDFA(benchmark::State& state, const char* regexp,
+                         absl::string_view text, Prog::Anchor anchor,
+                         bool expect_match) {
+  ABSL_CHECK_EQ(anchor, Prog::kUnanchored);
+  Prog* prog = GetCachedProg(regexp);
+  ABSL_CHECK(prog->ReserveFlatDFA());
+  prog->TESTING_ONLY_skip_flat_dfa_wait();
+  for (auto _ : state) {
+    bool matched;
+    ABSL_CHECK(prog->SearchFlatDFA(text, absl::string_view(), &matched));
+    ABSL_CHECK_EQ(matched, expect_match);
+  }
+}
+
 void SearchCachedNFA(benchmark::State& state, const char* regexp,
                      absl::string_view text, Prog::Anchor anchor,
                      bool expect_match) {
@@ -1574,6 +1621,76 @@ BENCHMARK_RANGE(FullMatch_DotStarCapture_CachedPCRE, 8, 2<<20);
 #endif
 BENCHMARK_RANGE(FullMatch_DotStarCapture_CachedRE2,  8, 2<<20);
 
+// Parses lines of metrics, which are mostly numbers of one kind or another.
+void FullMatch_Numbers(benchmark::State& state) {
+  std::vector<std::string> lines;
+  for (int i = 0; i < 1000; i++)
+    lines.push_back(absl::StrFormat("cpu%d %d %d %.3f %g 0x%x", i % 16,
+                                    i * 7919, -i, i / 7.0, i * 1e-3, i));
+  RE2 re("cpu(\\d+) (-?\\d+) (-?\\d+) (\\S+) (\\S+) (\\S+)");
+  int cpu;
+  int64_t count;
+  int delta;
+  double mean;
+  double rate;
+  uint32_t flags;
+  for (auto _ : state) {
+    for (const std::string& line : lines) {
+      ABSL_CHECK(RE2::FullMatch(line, re, &cpu, &count, &delta, &mean, &rate,
+                                RE2::CRadix(&flags)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * lines.size());
+}
+
+BENCHMARK(FullMatch_Numbers)->ThreadRange(1, NumCPUs());
+
+// Picks just the status out of lines of an access log.
+static const char kAccessLogRegexp[] =
+    "(\\S+) (\\S+) (\\S+) \\[([^]]+)\\] \"(\\w+) (\\S+) ([^\"]+)\" "
+    "(\\d+) (\\d+) \"([^\"]*)\" \"([^\"]*)\"";
+
+std::vector<std::string> AccessLog() {
+  std::vector<std::string> lines;
+  for (int i = 0; i < 1000; i++)
+    lines.push_back(absl::StrFormat(
+        "10.0.%d.%d - user%d [10/Oct/2026:13:%02d:%02d +0000] "
+        "\"GET /index/%d.html HTTP/1.1\" %d %d \"http://example.com/\" "
+        "\"Mozilla/5.0 (X11; Linux x86_64)\"",
+        i % 256, i % 7, i % 97, i % 60, i % 59, i, 200 + i % 5, i * 31));
+  return lines;
+}
+
+void Submatch_Match(benchmark::State& state) {
+  std::vector<std::string> lines = AccessLog();
+  RE2 re(kAccessLogRegexp);
+  for (auto _ : state) {
+    for (const std::string& line : lines) {
+      absl::string_view sub[9];
+      ABSL_CHECK(re.Match(line, 0, line.size(), RE2::UNANCHORED, sub, 9));
+      benchmark::DoNotOptimize(sub[8]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * lines.size());
+}
+
+void Submatch_Submatcher(benchmark::State& state) {
+  std::vector<std::string> lines = AccessLog();
+  RE2 re(kAccessLogRegexp);
+  RE2::Submatcher sm(re, {8});
+  for (auto _ : state) {
+    for (const std::string& line : lines) {
+      absl::string_view status;
+      ABSL_CHECK(sm.Match(line, 0, line.size(), RE2::UNANCHORED, &status));
+      benchmark::DoNotOptimize(status);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * lines.size());
+}
+
+BENCHMARK(Submatch_Match)->ThreadRange(1, NumCPUs());
+BENCHMARK(Submatch_Submatcher)->ThreadRange(1, NumCPUs());
+
 void PossibleMatchRangeCommon(benchmark::State& state, const char* regexp) {
   RE2 re(regexp);
   std::string min;
@@ -1602,4 +1719,235 @@ BENCHMARK(PossibleMatchRange_Complex);
 BENCHMARK(PossibleMatchRange_Prefix);
 BENCHMARK(PossibleMatchRange_NoProg);
 
+// Makes a log of nbytes in which to scrub the email addresses.
+std::string EmailLog(int64_t nbytes) {
+  std::string log;
+  for (int i = 0; log.size() < static_cast<size_t>(nbytes); i++)
+    log += absl::StrFormat("%d user%d@example.com logged in\n", i, i % 97);
+  log.resize(nbytes);
+  return log;
+}
+
+void GlobalReplace_String(benchmark::State& state) {
+  std::string log = EmailLog(state.range(0));
+  RE2 re("(\\w+)@(\\w+)\\.com");
+  for (auto _ : state) {
+    std::string s = log;
+    RE2::GlobalReplace(&s, re, "<\\1 at \\2>");
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void GlobalReplace_Template(benchmark::State& state) {
+  std::string log = EmailLog(state.range(0));
+  RE2 re("(\\w+)@(\\w+)\\.com");
+  RE2::RewriteTemplate rewrite(re, "<\\1 at \\2>");
+  for (auto _ : state) {
+    std::string s = log;
+    RE2::GlobalReplace(&s, re, rewrite);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// Masks every run of digits, of which there are several per line,
+// so that the cost per match dominates the cost per byte.
+void GlobalReplace_Dense(benchmark::State& state) {
+  std::string log = EmailLog(state.range(0));
+  RE2 re("\\d+");
+  for (auto _ : state) {
+    std::string s = log;
+    RE2::GlobalReplace(&s, re, "#");
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void FindAll_Dense(benchmark::State& state) {
+  std::string log = EmailLog(state.range(0));
+  RE2 re("(\\d+)");
+  for (auto _ : state) {
+    absl::string_view sub[2];
+    int n = 0;
+    RE2::FindAll all(log, re, sub, 2);
+    while (all.Next())
+      n++;
+    benchmark::DoNotOptimize(n);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void FindAndConsume_Dense(benchmark::State& state) {
+  std::string log = EmailLog(state.range(0));
+  RE2 re("(\\d+)");
+  for (auto _ : state) {
+    absl::string_view input(log);
+    absl::string_view digits;
+    int n = 0;
+    while (RE2::FindAndConsume(&input, re, &digits))
+      n++;
+    benchmark::DoNotOptimize(n);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// Makes nbytes of comma-separated fields, some of them padded.
+std::string CSVText(int64_t nbytes) {
+  std::string text;
+  for (int i = 0; static_cast<int64_t>(text.size()) < nbytes; i++)
+    absl::StrAppendFormat(&text, i % 3 == 0 ? "%d , " : "field%d,", i);
+  text.resize(nbytes);
+  return text;
+}
+
+// Splits the old way, with a loop around Match().
+void SplitMatch(benchmark::State& state, const char* regexp) {
+  std::string text = CSVText(state.range(0));
+  RE2 re(regexp);
+  std::vector<absl::string_view> pieces;
+  for (auto _ : state) {
+    pieces.clear();
+    size_t pos = 0;
+    absl::string_view match;
+    while (re.Match(text, pos, text.size(), RE2::UNANCHORED, &match, 1)) {
+      pieces.emplace_back(text.data() + pos, match.data() - text.data() - pos);
+      pos = match.data() + match.size() - text.data();
+    }
+    pieces.emplace_back(text.data() + pos, text.size() - pos);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void SplitSplit(benchmark::State& state, const char* regexp) {
+  std::string text = CSVText(state.range(0));
+  RE2 re(regexp);
+  std::vector<absl::string_view> pieces;
+  for (auto _ : state) {
+    pieces.clear();
+    RE2::Split(text, re, 0, &pieces);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void Split_Literal_Match(benchmark::State& state) { SplitMatch(state, ","); }
+void Split_Literal_Split(benchmark::State& state) { SplitSplit(state, ","); }
+void Split_Regexp_Match(benchmark::State& state) { SplitMatch(state, " *, *"); }
+void Split_Regexp_Split(benchmark::State& state) { SplitSplit(state, " *, *"); }
+
+// Makes nbytes of random text, ending in a match for "boundary=(\\w+)",
+// split into chunks of 4kB, as an absl::Cord might be.
+std::vector<absl::string_view> ChunkedText(int64_t nbytes,
+                                           std::string* text) {
+  *text = RandomText(nbytes);
+  const char kBoundary[] = " boundary=xyz123";
+  if (text->size() >= sizeof kBoundary)
+    text->replace(text->size() - (sizeof kBoundary - 1),
+                  sizeof kBoundary - 1, kBoundary);
+  std::vector<absl::string_view> chunks;
+  for (size_t i = 0; i < text->size(); i += 4096)
+    chunks.push_back(absl::string_view(*text).substr(i, 4096));
+  return chunks;
+}
+
+void Chunks_Flatten(benchmark::State& state) {
+  std::string text;
+  std::vector<absl::string_view> chunks = ChunkedText(state.range(0), &text);
+  RE2 re("boundary=(\\w+)");
+  absl::string_view sub[2];
+  for (auto _ : state) {
+    std::string flat;
+    for (absl::string_view chunk : chunks)
+      flat.append(chunk.data(), chunk.size());
+    re.Match(flat, 0, flat.size(), RE2::UNANCHORED, sub, 2);
+    benchmark::DoNotOptimize(sub[1].size());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void Chunks_MatchChunks(benchmark::State& state) {
+  std::string text;
+  std::vector<absl::string_view> chunks = ChunkedText(state.range(0), &text);
+  RE2 re("boundary=(\\w+)");
+  absl::string_view sub[2];
+  std::string buf;
+  for (auto _ : state) {
+    re.MatchChunks(chunks.data(), static_cast<int>(chunks.size()),
+                   RE2::UNANCHORED, sub, 2, &buf, NULL);
+    benchmark::DoNotOptimize(sub[1].size());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// Tokens of a little query language, keywords first.
+static const char* kQueryTokens[] = {
+  "select|from|where|and|or|not|order|by|limit",
+  "[A-Za-z_]\\w*",
+  "\\d+(?:\\.\\d*)?",
+  "'[^']*'",
+  "<=|>=|<>|[<>=]",
+  "[(),.*;]",
+  "\\s+",
+};
+
+std::string QueryText(int64_t nbytes) {
+  std::string text;
+  for (int i = 0; text.size() < static_cast<size_t>(nbytes); i++)
+    absl::StrAppendFormat(&text,
+                          "select name, id%d from users where age >= %d.5 "
+                          "and city <> 'x%d' order by name limit %d;\n",
+                          i % 10, i % 90, i, i % 1000);
+  text.resize(nbytes);
+  return text;
+}
+
+void Lexer_Consume(benchmark::State& state) {
+  std::string text = QueryText(state.range(0));
+  std::vector<std::unique_ptr<RE2>> tokens;
+  for (const char* pattern : kQueryTokens)
+    tokens.emplace_back(new RE2(pattern, RE2::Latin1));
+  for (auto _ : state) {
+    // Maximal munch the old way: try each of the regexps in turn.
+    absl::string_view input(text);
+    while (!input.empty()) {
+      size_t longest = 0;
+      for (const auto& re : tokens) {
+        absl::string_view rest(input);
+        if (RE2::Consume(&rest, *re))
+          longest = std::max(longest, input.size() - rest.size());
+      }
+      input.remove_prefix(longest > 0 ? longest : 1);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void Lexer_Lexer(benchmark::State& state) {
+  std::string text = QueryText(state.range(0));
+  RE2::Lexer lexer(RE2::Latin1);
+  for (const char* pattern : kQueryTokens)
+    ABSL_CHECK_GE(lexer.Add(pattern, NULL), 0);
+  ABSL_CHECK(lexer.Compile());
+  for (auto _ : state) {
+    absl::string_view input(text);
+    while (!input.empty()) {
+      if (lexer.Consume(&input, NULL, 0) < 0)
+        input.remove_prefix(1);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_RANGE(Lexer_Consume, 8, 2<<20);
+BENCHMARK_RANGE(Lexer_Lexer, 8, 2<<20);
+
+BENCHMARK_RANGE(GlobalReplace_String, 8, 2<<20);
+BENCHMARK_RANGE(GlobalReplace_Template, 8, 2<<20);
+BENCHMARK_RANGE(GlobalReplace_Dense, 8, 2<<20);
+BENCHMARK_RANGE(FindAll_Dense, 8, 2<<20);
+BENCHMARK_RANGE(FindAndConsume_Dense, 8, 2<<20);
+BENCHMARK_RANGE(Split_Literal_Match, 8, 2<<20);
+BENCHMARK_RANGE(Split_Literal_Split, 8, 2<<20);
+BENCHMARK_RANGE(Split_Regexp_Match, 8, 2<<20);
+BENCHMARK_RANGE(Split_Regexp_Split, 8, 2<<20);
+BENCHMARK_RANGE(Chunks_Flatten, 8, 2<<20);
+BENCHMARK_RANGE(Chunks_MatchChunks, 8, 2<<20);
+
 }  // namespace re2
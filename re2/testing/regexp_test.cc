@@ -84,4 +84,39 @@ TEST(Regexp, CaptureNames) {
   delete have;
 }
 
+TEST(Regexp, ByteLengthRange) {
+  struct {
+    const char* regexp;
+    Regexp::ParseFlags flags;
+    int min;
+    int max;
+  } tests[] = {
+    { "", Regexp::LikePerl, 0, 0 },
+    { "abc", Regexp::LikePerl, 3, 3 },
+    { "(?i)abc", Regexp::LikePerl, 3, 3 },
+    { "(?i)k", Regexp::LikePerl, 1, 3 },
+    { "^\\w{1,64}$", Regexp::LikePerl, 1, 64 },
+    { "(\\d{3}-){1,200}", Regexp::LikePerl, 4, 800 },
+    { "[a-z]{2,}", Regexp::LikePerl, 2, -1 },
+    { "ab*c", Regexp::LikePerl, 2, -1 },
+    { "ab?c|d", Regexp::LikePerl, 1, 3 },
+    { "(?s).", Regexp::LikePerl, 1, 4 },
+    { "(?s).", Regexp::LikePerl|Regexp::Latin1, 1, 1 },
+    { "\\C{3}", Regexp::LikePerl, 3, 3 },
+    { "[a\\x{10000}]", Regexp::LikePerl, 1, 4 },
+    { "\\x{e9}\\x{20ac}", Regexp::LikePerl, 5, 5 },
+    { "\\b(?:)*x{0}", Regexp::LikePerl, 0, 0 },
+    { "\\pL{1000}", Regexp::LikePerl, 1000, 4000 },
+  };
+  for (const auto& t : tests) {
+    Regexp* re = Regexp::Parse(t.regexp, t.flags, NULL);
+    ASSERT_TRUE(re != NULL) << t.regexp;
+    int min, max;
+    re->ByteLengthRange(&min, &max);
+    EXPECT_EQ(t.min, min) << t.regexp;
+    EXPECT_EQ(t.max, max) << t.regexp;
+    re->Decref();
+  }
+}
+
 }  // namespace re2
@@ -0,0 +1,181 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re2/replace_set.h"
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "gtest/gtest.h"
+#include "re2/re2.h"
+
+namespace re2 {
+
+TEST(ReplaceSet, Basic) {
+  RE2::ReplaceSet s(RE2::Quiet);
+  std::string error;
+
+  ASSERT_EQ(s.Add("(\\w+)@example\\.com", "\\1@<redacted>", &error), 0);
+  ASSERT_EQ(s.Add("(", "x", &error), -1);
+  ASSERT_FALSE(error.empty());
+  error.clear();
+  ASSERT_EQ(s.Add("a(b)", "\\2", &error), -1);
+  ASSERT_FALSE(error.empty());
+  ASSERT_EQ(s.Add("AKIA[0-9A-Z]{4}", "<key>", NULL), 1);
+  ASSERT_EQ(s.Add("\\d+", "#", NULL), 2);
+  ASSERT_TRUE(s.Compile());
+
+  std::string str = "key AKIA12AB for bob@example.com, not bob@example.org";
+  ASSERT_EQ(s.GlobalReplace(&str), 2);
+  ASSERT_EQ(str, "key <key> for bob@<redacted>, not bob@example.org");
+
+  // Replacements are not subject to re-matching by the other regexps.
+  str = "12 AKIA1234";
+  ASSERT_EQ(s.GlobalReplace(&str), 2);
+  ASSERT_EQ(str, "# <key>");
+
+  str = "nothing to see here";
+  ASSERT_EQ(s.GlobalReplace(&str), 0);
+  ASSERT_EQ(str, "nothing to see here");
+
+  std::string out;
+  ASSERT_EQ(s.GlobalReplace("mail 7@example.com",
+                            [&](absl::string_view piece) {
+                              out.append(piece.data(), piece.size());
+                            }),
+            1);
+  ASSERT_EQ(out, "mail 7@<redacted>");
+}
+
+TEST(ReplaceSet, Priority) {
+  // Where more than one of the regexps could match at the same place,
+  // the one added first wins, regardless of which match is longer...
+  RE2::ReplaceSet s(RE2::DefaultOptions);
+  ASSERT_EQ(s.Add("ab", "<1>", NULL), 0);
+  ASSERT_EQ(s.Add("abc", "<2>", NULL), 1);
+  ASSERT_EQ(s.Add("b\\w*", "<3>", NULL), 2);
+  ASSERT_TRUE(s.Compile());
+
+  std::string str = "abc xbc";
+  ASSERT_EQ(s.GlobalReplace(&str), 2);
+  ASSERT_EQ(str, "<1>c x<3>");
+
+  // ... unless longest_match is set.
+  RE2::Options options;
+  options.set_longest_match(true);
+  RE2::ReplaceSet t(options);
+  ASSERT_EQ(t.Add("ab", "<1>", NULL), 0);
+  ASSERT_EQ(t.Add("abc", "<2>", NULL), 1);
+  ASSERT_TRUE(t.Compile());
+
+  str = "abc";
+  ASSERT_EQ(t.GlobalReplace(&str), 1);
+  ASSERT_EQ(str, "<2>");
+}
+
+TEST(ReplaceSet, Context) {
+  // Each match is checked in the context of the whole text.
+  RE2::ReplaceSet s(RE2::DefaultOptions);
+  ASSERT_EQ(s.Add("\\bx", "<1>", NULL), 0);
+  ASSERT_EQ(s.Add("(?m)^y", "<2>", NULL), 1);
+  ASSERT_EQ(s.Add("[xy]", "<3>", NULL), 2);
+  ASSERT_EQ(s.Add("z$", "<4>", NULL), 3);
+  ASSERT_EQ(s.Add("z", "<5>", NULL), 4);
+  ASSERT_TRUE(s.Compile());
+
+  std::string str = "x ax y\nyy z z";
+  ASSERT_EQ(s.GlobalReplace(&str), 7);
+  ASSERT_EQ(str, "<1> a<3> <3>\n<2><3> <5> <4>");
+
+  RE2::ReplaceSet t(RE2::DefaultOptions);
+  ASSERT_EQ(t.Add("a\\B", "<1>", NULL), 0);
+  ASSERT_EQ(t.Add("a", "<2>", NULL), 1);
+  ASSERT_EQ(t.Add("\\bb", "<3>", NULL), 2);
+  ASSERT_EQ(t.Add("[ab]", "<4>", NULL), 3);
+  ASSERT_TRUE(t.Compile());
+
+  str = "ab a !b";
+  ASSERT_EQ(t.GlobalReplace(&str), 4);
+  ASSERT_EQ(str, "<1><4> <2> !<3>");
+}
+
+TEST(ReplaceSet, Syntax) {
+  // Each of the regexps is parsed on its own, even if \Q is left open.
+  RE2::ReplaceSet s(RE2::DefaultOptions);
+  ASSERT_EQ(s.Add("\\Qa|b", "<1>", NULL), 0);
+  ASSERT_EQ(s.Add("(?i)c", "<2>", NULL), 1);
+  ASSERT_EQ(s.Add("C", "<3>", NULL), 2);
+  ASSERT_EQ(s.Add("\\Q\\\\E", "<4>", NULL), 3);
+  ASSERT_TRUE(s.Compile());
+
+  std::string str = "a|b a C c A\\";
+  ASSERT_EQ(s.GlobalReplace(&str), 4);
+  ASSERT_EQ(str, "<1> a <2> <2> A<4>");
+
+  RE2::Options options;
+  options.set_literal(true);
+  RE2::ReplaceSet t(options);
+  ASSERT_EQ(t.Add("a.b", "<1>", NULL), 0);
+  ASSERT_EQ(t.Add("(", "<2>", NULL), 1);
+  ASSERT_TRUE(t.Compile());
+
+  str = "a.b axb (";
+  ASSERT_EQ(t.GlobalReplace(&str), 2);
+  ASSERT_EQ(str, "<1> axb <2>");
+}
+
+TEST(ReplaceSet, Empty) {
+  RE2::ReplaceSet s(RE2::DefaultOptions);
+  ASSERT_TRUE(s.Compile());
+
+  std::string str = "abc";
+  ASSERT_EQ(s.GlobalReplace(&str), 0);
+  ASSERT_EQ(str, "abc");
+}
+
+TEST(ReplaceSet, LikeGlobalReplaceOfAlternation) {
+  // With one regexp per group, the alternation of all of the regexps can
+  // do the same job with a rewrite that is all of the rewrites at once.
+  RE2::ReplaceSet s(RE2::DefaultOptions);
+  std::string alternation;
+  for (int i = 0; i < 9; i++) {
+    std::string pattern = absl::StrFormat("(%d[a-z]*%d)", i, (i + 1) % 10);
+    ASSERT_EQ(s.Add(pattern, absl::StrFormat("<%d>", i), NULL), i);
+    if (i > 0)
+      alternation += '|';
+    alternation += pattern;
+  }
+  ASSERT_TRUE(s.Compile());
+
+  std::string text;
+  for (int i = 0; i < 1000; i++)
+    absl::StrAppendFormat(&text, "%dabc%d %d", i % 10, i % 7, i);
+
+  RE2 re(alternation);
+  std::string want(text);
+  int count = 0;
+  std::string out;
+  absl::string_view vec[10];
+  size_t pos = 0;
+  while (re.Match(want, pos, want.size(), RE2::UNANCHORED, vec, 10)) {
+    out.append(want, pos, vec[0].data() - want.data() - pos);
+    for (int i = 1; i < 10; i++) {
+      if (vec[i].data() != NULL)
+        absl::StrAppendFormat(&out, "<%d>", i - 1);
+    }
+    pos = vec[0].data() + vec[0].size() - want.data();
+    count++;
+  }
+  out.append(want, pos, std::string::npos);
+
+  std::string str(text);
+  ASSERT_EQ(s.GlobalReplace(&str), count);
+  ASSERT_EQ(str, out);
+}
+
+}  // namespace re2
@@ -297,6 +297,23 @@ RegexpTest simple_tests[] = {
   { "^", "a" },
   { "^^", "a" },
 
+  // Required inner literals.
+  { "\\w+@example\\.com", "mail bob@example.com or x@example.co" },
+  { "[0-9]+ERROR[0-9]+", "12ERROR 34ERROR56ERROR7" },
+  { "a*bc", "aabxabcaabc" },
+  { "(x+)yz(w*)", "xxyxyzwwxyz" },
+  { "[^y]*yz", "ayaayzz" },
+  { "\\bfoo\\b.*bar", "foo xfoo bar" },
+  { "(?:a|b)cd(?:e|f)", "abcdbcdf" },
+  { "a+ab", "aaab" },
+  { "[0-9]ab", "ab ab ab ab ab ab ab ab ab ab 1ab" },
+  { "[a-z0-9._%+-]+\\.(exe|dll)", "run setup.exe or lib.dll" },
+  { "[a-z.]+\\.exe", ".exe.exe" },
+  { "(?:a\\.exe|x)\\.exe", "a.exe.exe" },
+  { "[a-z]+(?:ab|b[cd])", "zbd cab ab" },
+  { "(?i)[a-z]+\\.exe", "RUN.EXE" },
+  { "\\w+?\\.(?:exe|dll)", "x.dll.exe" },
+
   // Context.
   // The tester checks for a match in the text and
   // subpieces of the text with a byte removed on either side.
@@ -314,6 +331,7 @@ RegexpTest simple_tests[] = {
   { "\\w*I\\w*", "Inc." },
   { "(?:|a)*", "aaa" },
   { "(?:|a)+", "aaa" },
+  { "\\bfoo\\b.*bar", "foox foo bar" },
 };
 
 TEST(Regexp, SearchTests) {
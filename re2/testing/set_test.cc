@@ -6,9 +6,16 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/string_view.h"
+
 #include "gtest/gtest.h"
 #include "re2/re2.h"
 
@@ -227,4 +234,47 @@ TEST(Set, MoveSemantics) {
   ASSERT_EQ(s1.Match("abc bar2 xyz", NULL), false);
 }
 
+// Calls fn(i) for every i in [0, n) on a few threads.
+static void ThreadedFor(int n, const std::function<void(int i)>& fn) {
+  std::atomic<int> next(0);
+  std::vector<std::thread> threads;
+  for (int j = 0; j < 4; j++) {
+    threads.emplace_back([&]() {
+      for (int i; (i = next.fetch_add(1)) < n;)
+        fn(i);
+    });
+  }
+  for (std::thread& t : threads)
+    t.join();
+}
+
+TEST(Set, AddAll) {
+  std::vector<absl::string_view> patterns = {
+      "foo", "(", "bar", "b[aeiou]z", "[", "\\d+x",
+  };
+
+  RE2::Set s1(RE2::Quiet, RE2::UNANCHORED);
+  for (absl::string_view pattern : patterns)
+    s1.Add(pattern, NULL);
+  ASSERT_EQ(s1.Compile(), true);
+
+  RE2::Set s2(RE2::Quiet, RE2::UNANCHORED);
+  std::vector<int> indices;
+  std::vector<std::string> errors;
+  s2.AddAll(patterns, ThreadedFor, &indices, &errors);
+  ASSERT_EQ(indices, std::vector<int>({0, -1, 1, 2, -1, 3}));
+  ASSERT_EQ(errors.size(), size_t{6});
+  ASSERT_TRUE(errors[0].empty());
+  ASSERT_EQ(errors[1], "missing ): (");
+  ASSERT_EQ(s2.Compile(), true);
+
+  for (absl::string_view text : {"foo bar", "baz", "12x", "bat", ""}) {
+    std::vector<int> v1, v2;
+    ASSERT_EQ(s1.Match(text, &v1), s2.Match(text, &v2));
+    std::sort(v1.begin(), v1.end());
+    std::sort(v2.begin(), v2.end());
+    ASSERT_EQ(v1, v2);
+  }
+}
+
 }  // namespace re2
@@ -0,0 +1,98 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re2/static_dfa.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "gtest/gtest.h"
+#include "re2/prog.h"
+#include "re2/re2.h"
+#include "re2/regexp.h"
+#include "re2/testing/string_generator.h"
+
+namespace re2 {
+
+// The tables for a StaticDFA, built the same way as by make_static_dfa.
+struct Tables {
+  int nbytes;
+  std::vector<uint8_t> bytemap;
+  std::vector<int32_t> next;
+  std::unique_ptr<bool[]> match;
+};
+
+static void BuildTables(const RE2& re, Tables* t) {
+  std::unique_ptr<Prog> prog(
+      re.Regexp()->CompileToProg(re.options().max_mem()*2/3));
+  ASSERT_TRUE(prog != NULL);
+  t->nbytes = prog->bytemap_range() + 1;
+  t->bytemap.assign(prog->bytemap(), prog->bytemap() + 256);
+  t->next.clear();
+  std::vector<bool> match;
+  prog->BuildEntireDFA(Prog::kLongestMatch, [&](const int* next, bool m) {
+    ASSERT_TRUE(next != NULL);
+    t->next.insert(t->next.end(), next, next + t->nbytes);
+    match.push_back(m);
+  });
+  if (match.empty()) {
+    t->next.assign(t->nbytes, -1);
+    match.push_back(false);
+  }
+  t->match.reset(new bool[match.size()]);
+  for (size_t i = 0; i < match.size(); i++)
+    t->match[i] = match[i];
+}
+
+static const char* patterns[] = {
+  "",
+  "a",
+  "ab",
+  "a*b",
+  "a+$",
+  "^ab",
+  "(?m)^b",
+  "(?m)a$",
+  "\\bab\\b",
+  "\\Bb",
+  "(?i)AB",
+  "\\pL\\pL",
+  "[^a]b",
+  "a|bx|",
+  "\xc3\xa9+",
+  "[^\\x00-\\x{10ffff}]",
+};
+
+TEST(StaticDFA, MatchesLikeRE2) {
+  std::vector<std::string> alphabet = {"a", "b", "x", " ", "\n", "\xc3\xa9"};
+  for (const char* pattern : patterns) {
+    RE2 re(pattern);
+    ASSERT_TRUE(re.ok()) << pattern;
+    RE2 anchored(std::string("\\A(?:") + pattern + ")\\z");
+    ASSERT_TRUE(anchored.ok()) << pattern;
+
+    Tables t, ta;
+    BuildTables(re, &t);
+    BuildTables(anchored, &ta);
+    StaticDFA dfa(t.bytemap.data(), t.nbytes, t.next.data(), t.match.get());
+    StaticDFA full(ta.bytemap.data(), ta.nbytes, ta.next.data(),
+                   ta.match.get());
+
+    StringGenerator g(5, alphabet);
+    while (g.HasNext()) {
+      absl::string_view text = g.Next();
+      EXPECT_EQ(RE2::PartialMatch(text, re), dfa.Match(text))
+          << pattern << " on \"" << text << "\"";
+      EXPECT_EQ(RE2::FullMatch(text, re), full.Match(text))
+          << pattern << " on \"" << text << "\"";
+    }
+  }
+}
+
+}  // namespace re2
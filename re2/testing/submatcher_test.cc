@@ -0,0 +1,117 @@
+// Copyright 2026 The RE2 Authors.  All Rights Reserved.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re2/submatcher.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "gtest/gtest.h"
+#include "re2/re2.h"
+
+namespace re2 {
+
+TEST(Submatcher, Basic) {
+  RE2 re("(\\S+) (\\S+) (\\S+) (?P<status>\\d+) (?P<size>\\d+)");
+  ASSERT_TRUE(re.ok());
+  std::string line = "host - GET 404 1234";
+
+  RE2::Submatcher byindex(re, {4, 0, 2});
+  ASSERT_EQ(byindex.size(), 3);
+  absl::string_view sub[3];
+  ASSERT_TRUE(byindex.Match(line, 0, line.size(), RE2::UNANCHORED, sub));
+  ASSERT_EQ(sub[0], "404");
+  ASSERT_EQ(sub[1], line);
+  ASSERT_EQ(sub[2], "-");
+
+  const std::map<std::string, int>& named = re.NamedCapturingGroups();
+  RE2::Submatcher byname(re, {named.at("size"), named.at("status"), 6});
+  ASSERT_EQ(byname.size(), 3);
+  ASSERT_TRUE(byname.Match(line, 0, line.size(), RE2::ANCHOR_BOTH, sub));
+  ASSERT_EQ(sub[0], "1234");
+  ASSERT_EQ(sub[1], "404");
+  ASSERT_EQ(sub[2].data(), nullptr);
+
+  ASSERT_FALSE(byname.Match("host - GET x 1", 0, 14, RE2::UNANCHORED, sub));
+  ASSERT_FALSE(byname.Match(line, 5, line.size(), RE2::ANCHOR_BOTH, sub));
+}
+
+TEST(Submatcher, Groups) {
+  // Groups that don't exist are empty, and the same group can be asked for
+  // more than once.
+  RE2 re("a(b)?(c)");
+  RE2::Submatcher sm(re, {-1, 3, 1, 2, 1});
+  absl::string_view sub[5];
+  ASSERT_TRUE(sm.Match("xac", 0, 3, RE2::UNANCHORED, sub));
+  ASSERT_EQ(sub[0].data(), nullptr);
+  ASSERT_EQ(sub[1].data(), nullptr);
+  ASSERT_EQ(sub[2].data(), nullptr);
+  ASSERT_EQ(sub[3], "c");
+  ASSERT_EQ(sub[4].data(), nullptr);
+  ASSERT_TRUE(sm.Match("xabc", 0, 4, RE2::UNANCHORED, sub));
+  ASSERT_EQ(sub[2], "b");
+  ASSERT_EQ(sub[4], "b");
+
+  RE2::Submatcher none(re, std::vector<int>());
+  ASSERT_EQ(none.size(), 0);
+  ASSERT_TRUE(none.Match("abc", 0, 3, RE2::UNANCHORED, NULL));
+  ASSERT_FALSE(none.Match("ab", 0, 2, RE2::UNANCHORED, NULL));
+
+  RE2 bad("a(", RE2::Quiet);
+  RE2::Submatcher sbad(bad, {0, 1});
+  ASSERT_FALSE(sbad.Match("a(", 0, 2, RE2::UNANCHORED, sub));
+}
+
+TEST(Submatcher, LikeMatch) {
+  // Whichever engine finds them, the groups are the same as Match() finds.
+  struct {
+    const char* regexp;
+    const char* text;
+    bool longest_match;
+  } tests[] = {
+    { "(a+)(b+)?(a*)(b)", "xxaaabbbaabab", false },
+    { "(a+)(b+)?(a*)(b)", "xxaaabbbaabab", true },
+    { "(a|ab)(c|bcd)(d*)", "abcd", false },
+    { "(a|ab)(c|bcd)(d*)", "abcd", true },
+    { "^(\\w+)@(\\w+)\\.(com|org)$", "bob@example.org", false },
+    { "(x)(y)?(z)?(w)?(v)?(u)?(t)?", "xyzwvut", false },
+    { "(\\w+)\\s+(\\w+)\\b(.*)", "hello, big wide world", false },
+    { "((a)|(b))+(\\d)", "aababb7", false },
+    { "prefix(\\d+)-(\\d+)", "prefix12-34", false },
+  };
+  for (const auto& t : tests) {
+    RE2::Options options;
+    options.set_longest_match(t.longest_match);
+    RE2 re(t.regexp, options);
+    ASSERT_TRUE(re.ok()) << t.regexp;
+    int ngroup = re.NumberOfCapturingGroups();
+    std::vector<absl::string_view> want(1 + ngroup);
+
+    std::string text(t.text);
+    // The match is far into the text, and sometimes long itself.
+    std::string big = std::string(100000, ' ') + text +
+                      std::string(100000, 'z');
+    for (const std::string& s : {text, big}) {
+      for (RE2::Anchor anchor : {RE2::UNANCHORED, RE2::ANCHOR_START}) {
+        bool matched = re.Match(s, 0, s.size(), anchor, want.data(),
+                                static_cast<int>(want.size()));
+        for (int g = 1; g <= ngroup; g++) {
+          RE2::Submatcher sm(re, {g, 0});
+          absl::string_view sub[2];
+          ASSERT_EQ(sm.Match(s, 0, s.size(), anchor, sub), matched)
+              << t.regexp;
+          if (!matched)
+            continue;
+          ASSERT_EQ(sub[0].data(), want[g].data()) << t.regexp << " " << g;
+          ASSERT_EQ(sub[0].size(), want[g].size()) << t.regexp << " " << g;
+          ASSERT_EQ(sub[1], want[0]);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace re2
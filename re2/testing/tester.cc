@@ -45,8 +45,10 @@ const char* engine_names[kEngineMax] = {
   "NFA",
   "DFA",
   "DFA1",
+  "FlatDFA",
   "OnePass",
   "BitState",
+  "BitParallel",
   "RE2",
   "RE2a",
   "RE2b",
@@ -220,6 +222,10 @@ TestInstance::TestInstance(absl::string_view regexp_str, Prog::MatchKind kind,
     error_ = true;
     return;
   }
+  // Set aside memory for the flat DFA before anything else can use it,
+  // and don't make the program search lots of text first.
+  if ((Engines() & (1<<kEngineFlatDFA)) && prog_->ReserveFlatDFA())
+    prog_->TESTING_ONLY_skip_flat_dfa_wait();
   if (absl::GetFlag(FLAGS_dump_prog)) {
     ABSL_LOG(INFO) << "Prog for "
                    << " regexp "
@@ -381,6 +387,17 @@ void TestInstance::RunSearch(Engine type, absl::string_view orig_text,
       result->have_submatch0 = true;
       break;
 
+    case kEngineFlatDFA:
+      if (prog_ == NULL ||
+          anchor == Prog::kAnchored ||
+          kind_ == Prog::kFullMatch) {
+        result->skipped = true;
+        break;
+      }
+      if (!prog_->SearchFlatDFA(text, context, &result->matched))
+        result->skipped = true;
+      break;
+
     case kEngineOnePass:
       if (prog_ == NULL ||
           !prog_->IsOnePass() ||
@@ -405,6 +422,22 @@ void TestInstance::RunSearch(Engine type, absl::string_view orig_text,
       result->have_submatch = true;
       break;
 
+    case kEngineBitParallel: {
+      if (prog_ == NULL ||
+          !prog_->CanBitParallel()) {
+        result->skipped = true;
+        break;
+      }
+      // Can only ask where the match ends if it is the longest one
+      // and it must start at the beginning of the text.
+      bool end = kind_ != Prog::kFirstMatch &&
+                 (anchor == Prog::kAnchored || prog_->anchor_start());
+      result->matched = prog_->SearchBitParallel(
+          text, context, anchor, kind_, end ? result->submatch : NULL);
+      result->have_submatch0 = end;
+      break;
+    }
+
     case kEngineRE2:
     case kEngineRE2a:
     case kEngineRE2b: {
@@ -24,8 +24,10 @@ enum Engine {
   kEngineNFA,              // Prog::SearchNFA
   kEngineDFA,              // Prog::SearchDFA, only ask whether it matched
   kEngineDFA1,             // Prog::SearchDFA, ask for match[0]
+  kEngineFlatDFA,          // Prog::SearchFlatDFA, if applicable
   kEngineOnePass,          // Prog::SearchOnePass, if applicable
   kEngineBitState,         // Prog::SearchBitState
+  kEngineBitParallel,      // Prog::SearchBitParallel, if applicable
   kEngineRE2,              // RE2, all submatches
   kEngineRE2a,             // RE2, only ask for match[0]
   kEngineRE2b,             // RE2, only ask whether it matched
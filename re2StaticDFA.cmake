@@ -0,0 +1,14 @@
+# Copyright 2026 The RE2 Authors.  All Rights Reserved.
+# Use of this source code is governed by a BSD-style
+# license that can be found in the LICENSE file.
+
+# re2_static_dfa(OUTPUT NAME PATTERN ...) runs make_static_dfa at build time
+# to generate the tables for a re2::StaticDFA (see re2/static_dfa.h) as a
+# header; any further arguments are passed as flags.
+function(re2_static_dfa output name pattern)
+  add_custom_command(OUTPUT ${output}
+                     COMMAND re2::make_static_dfa ${ARGN} --output=${output}
+                             ${name} ${pattern}
+                     DEPENDS re2::make_static_dfa
+                     VERBATIM)
+endfunction()
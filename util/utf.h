@@ -36,6 +36,7 @@ enum
 int runetochar(char* s, const Rune* r);
 int chartorune(Rune* r, const char* s);
 int fullrune(const char* s, int n);
+int runelen(Rune r);
 int utflen(const char* s);
 char* utfrune(const char*, Rune);
 